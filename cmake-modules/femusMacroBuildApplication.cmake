@@ -32,7 +32,9 @@ ENDIF(HDF5_FOUND)
 
 FILE(MAKE_DIRECTORY ${PROJECT_BINARY_DIR}/output/)
 FILE(MAKE_DIRECTORY ${PROJECT_BINARY_DIR}/input/)
-FILE(COPY           ${PROJECT_SOURCE_DIR}/input/ DESTINATION ${PROJECT_BINARY_DIR}/input/)
+IF(EXISTS ${PROJECT_SOURCE_DIR}/input/)
+  FILE(COPY         ${PROJECT_SOURCE_DIR}/input/ DESTINATION ${PROJECT_BINARY_DIR}/input/)
+ENDIF(EXISTS ${PROJECT_SOURCE_DIR}/input/)
 
 
 ENDMACRO(femusMacroBuildApplication)
\ No newline at end of file
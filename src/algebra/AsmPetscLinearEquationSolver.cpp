@@ -545,6 +545,7 @@ namespace femus {
       PetscMatrix* KKp = static_cast< PetscMatrix* >(_KK);
       Mat KK = KKp->mat();
       KSPSetOperators(_ksp, KK, _Pmat);
+      this->set_petsc_solver_type(_ksp, _outer_solver_type);
       KSPSetTolerances(_ksp, _rtol, _abstol, _dtol, _maxits);
       KSPSetInitialGuessKnoll(_ksp, PETSC_TRUE);
       KSPSetFromOptions(_ksp);
@@ -697,9 +698,9 @@ namespace femus {
 
 // =================================================
 
-  void AsmPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp) {
+  void AsmPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp, const SolverType& solver_type) {
     int ierr = 0;
-    switch (this->_solver_type) {
+    switch (solver_type) {
       case CG:
         ierr = KSPSetType(ksp, (char*) KSPCG);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
@@ -752,9 +753,21 @@ namespace femus {
         ierr = KSPSetType(ksp, (char*) KSPPREONLY);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
         return;
+      case PIPECG:
+        ierr = KSPSetType(ksp, (char*) KSPPIPECG);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PIPEFGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPIPEFGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
       default:
         std::cerr << "ERROR:  Unsupported PETSC Solver: "
-                  << this->_solver_type               << std::endl
+                  << solver_type                      << std::endl
                   << "Continuing with PETSC defaults" << std::endl;
     }
   }
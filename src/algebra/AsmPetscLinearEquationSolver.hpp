@@ -114,7 +114,12 @@ private:
     void solve(const vector <unsigned> &variable_to_be_solved, const bool &ksp_clean);
 
     /**  Set the user-specified solver stored in \p _solver_type */
-    void set_petsc_solver_type ( KSP &ksp );
+    void set_petsc_solver_type ( KSP &ksp ) {
+      set_petsc_solver_type ( ksp, this->_solver_type );
+    };
+
+    /**  Set the solver \p solver_type on the given ksp */
+    void set_petsc_solver_type ( KSP &ksp, const SolverType &solver_type );
 
     /** To be Added */
     clock_t BuildBDCIndex(const vector <unsigned> &variable_to_be_solved);
@@ -195,6 +195,89 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
     return SearchTime;
   }
 
+  // ==============================================
+
+  clock_t FieldSplitPetscLinearEquationSolver::BuildSchurIndex() {
+    clock_t start_time = clock();
+
+    unsigned iproc = processor_id();
+
+    vector <bool> ThisIsPressure(_SolPdeIndex.size(), false);
+    for (unsigned i = 0; i < _schurPressureIndex.size(); i++) {
+      ThisIsPressure[_schurPressureIndex[i]] = true;
+    }
+
+    // split 0 collects all the non-pressure variables, split 1 the pressure ones
+    for (unsigned i = 0; i < _is_schur.size(); i++) {
+      ISDestroy(&_is_schur[i]);
+    }
+    _is_schur_idx.assign(2, vector <PetscInt> ());
+    _is_schur.resize(2);
+
+    for (unsigned k = 0; k < _SolPdeIndex.size(); k++) {
+      unsigned split = (ThisIsPressure[k]) ? 1 : 0;
+      for (unsigned j = KKoffset[k][iproc]; j < KKoffset[k + 1][iproc]; j++) {
+        _is_schur_idx[split].push_back(j);
+      }
+    }
+
+    // a process may own no dofs of one of the splits
+    for (unsigned i = 0; i < 2; i++) {
+      PetscErrorCode ierr;
+      PetscInt *schurIdx = (_is_schur_idx[i].size() > 0) ? &_is_schur_idx[i][0] : NULL;
+      ierr = ISCreateGeneral(MPI_COMM_WORLD, _is_schur_idx[i].size(), schurIdx, PETSC_USE_POINTER, &_is_schur[i]);
+      CHKERRABORT(MPI_COMM_WORLD, ierr);
+    }
+
+    return clock() - start_time;
+  }
+
+  // ==============================================
+
+  void FieldSplitPetscLinearEquationSolver::SetPetscSchurFieldSplit(KSP& ksp, PC& pc) {
+
+    PCFieldSplitSetIS(pc, NULL, _is_schur[0]);
+    PCFieldSplitSetIS(pc, NULL, _is_schur[1]);
+    PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR);
+    PCFieldSplitSetSchurFactType(pc, PC_FIELDSPLIT_SCHUR_FACT_UPPER);
+
+    if (_schurType == SIMPLE_SCHUR) {
+      // S ~ A11 - A10 diag(A00)^{-1} A01, assembled
+      PCFieldSplitSetSchurPre(pc, PC_FIELDSPLIT_SCHUR_PRE_SELFP, NULL);
+    }
+    else {
+      // least squares commutator applied to the unassembled Schur complement
+      PCFieldSplitSetSchurPre(pc, PC_FIELDSPLIT_SCHUR_PRE_SELF, NULL);
+    }
+
+    KSPSetUp(ksp);
+
+    KSP* subksps;
+    PetscInt nsplits;
+    PCFieldSplitGetSubKSP(pc, &nsplits, &subksps);
+
+    PetscReal epsilon = 1.e-16;
+    for (int i = 0; i < nsplits; i++) {
+      this->set_petsc_solver_type(subksps[i], _schurInnerSolver);
+      // a few inner iterations for each outer iteration
+      KSPSetTolerances(subksps[i], _rtol, _abstol, _dtol, _schurInnerMaxits);
+      KSPSetFromOptions(subksps[i]);
+
+      PC subpcs;
+      KSPGetPC(subksps[i], &subpcs);
+      if (i == 1 && _schurType == LSC_SCHUR) {
+        PCSetType(subpcs, (char*) PCLSC);
+      }
+      else {
+        PetscPreconditioner::set_petsc_preconditioner_type(_schurInnerPreconditioner, subpcs);
+        PCFactorSetZeroPivot(subpcs, epsilon);
+        PCFactorSetShiftType(subpcs, MAT_SHIFT_NONZERO);
+      }
+    }
+
+    PetscFree(subksps);
+  }
+
   // =================================================
 
   void FieldSplitPetscLinearEquationSolver::solve(const vector <unsigned>& variable_to_be_solved, const bool& ksp_clean) {
@@ -215,6 +298,8 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
       if (!_standard_ASM)
         BuildFieldSplitIndex(variable_to_be_solved);
       BuildBDCIndex(variable_to_be_solved);
+      if (_schurType != NO_SCHUR)
+        BuildSchurIndex();
     }
     SearchTime = start_time - clock();
     // ***************** END NODE/ELEMENT SEARCH *******************
@@ -306,6 +391,8 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
         BuildFieldSplitIndex(variable_to_be_solved);
         //END here
       BuildBDCIndex(variable_to_be_solved);
+      if (_schurType != NO_SCHUR)
+        BuildSchurIndex();
     }
 
     // ***************** END NODE/ELEMENT SEARCH *******************
@@ -352,6 +439,10 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
     //BEGIN from here
     
     PCSetType(subpc, (char*) PCFIELDSPLIT);
+    if (_schurType != NO_SCHUR) {
+      SetPetscSchurFieldSplit(subksp, subpc);
+    }
+    else {
     PCFieldSplitSetType(subpc, PC_COMPOSITE_ADDITIVE);
     for(int i=0; i<_is_loc.size(); i++ ){
       PCFieldSplitSetIS( subpc, NULL, _is_loc[i]);
@@ -375,6 +466,7 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
       PCFactorSetShiftType(subpcs, MAT_SHIFT_NONZERO);
               
     }
+    }
       
 
     //END here
@@ -413,6 +505,7 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
       PetscMatrix* KKp = static_cast< PetscMatrix* >(_KK);
       Mat KK = KKp->mat();
       KSPSetOperators(_ksp, KK, _Pmat);
+      this->set_petsc_solver_type(_ksp, _outer_solver_type);
       KSPSetTolerances(_ksp, _rtol, _abstol, _dtol, _maxits);
       KSPSetInitialGuessKnoll(_ksp, PETSC_TRUE);
       KSPSetFromOptions(_ksp);
@@ -499,6 +592,13 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
       ierr = KSPSetFromOptions(_ksp);
       CHKERRABORT(MPI_COMM_WORLD, ierr);
 
+      if (_schurType != NO_SCHUR) {
+        ierr = PCSetType(_pc, (char*) PCFIELDSPLIT);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        SetPetscSchurFieldSplit(_ksp, _pc);
+        return;
+      }
+
       PetscPreconditioner::set_petsc_preconditioner_type(ASM_PRECOND, _pc);
       if (!_standard_ASM) {
         ierr = PCASMSetLocalSubdomains(_pc, _is_loc_idx.size(), &_is_ovl[0], &_is_loc[0]);
@@ -565,9 +665,9 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
 
 // =================================================
 
-  void FieldSplitPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp) {
+  void FieldSplitPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp, const SolverType& solver_type) {
     int ierr = 0;
-    switch (this->_solver_type) {
+    switch (solver_type) {
       case CG:
         ierr = KSPSetType(ksp, (char*) KSPCG);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
@@ -620,9 +720,21 @@ PetscPrintf(PETSC_COMM_SELF,"First index %D\n",nindices[0]);
         ierr = KSPSetType(ksp, (char*) KSPPREONLY);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
         return;
+      case PIPECG:
+        ierr = KSPSetType(ksp, (char*) KSPPIPECG);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PIPEFGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPIPEFGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
       default:
         std::cerr << "ERROR:  Unsupported PETSC Solver: "
-                  << this->_solver_type               << std::endl
+                  << solver_type                      << std::endl
                   << "Continuing with PETSC defaults" << std::endl;
     }
   }
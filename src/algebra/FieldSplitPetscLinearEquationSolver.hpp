@@ -110,11 +110,29 @@ private:
         _NSchurVar=NSchurVar;
     };
 
+    /** Set a Schur complement field split (LSC or SIMPLE) with the Pde variables PressureIndex as second block,
+     * the inner solvers of the splits do at most innerMaxits iterations */
+    void SetSchurPreconditioner(const SchurPreconditioner &schurType, const vector <unsigned> &PressureIndex,
+                                const SolverType &innerSolver, const PreconditionerType &innerPreconditioner,
+                                const unsigned &innerMaxits) {
+        _schurType = schurType;
+        _schurPressureIndex = PressureIndex;
+        _schurInnerSolver = innerSolver;
+        _schurInnerPreconditioner = innerPreconditioner;
+        _schurInnerMaxits = static_cast<PetscInt>(innerMaxits);
+        _indexai_init = 0;
+    };
+
     /** Call the ASM smoother-solver using the PetscLibrary */
     void solve(const vector <unsigned> &variable_to_be_solved, const bool &ksp_clean);
 
     /**  Set the user-specified solver stored in \p _solver_type */
-    void set_petsc_solver_type ( KSP &ksp );
+    void set_petsc_solver_type ( KSP &ksp ) {
+      set_petsc_solver_type ( ksp, this->_solver_type );
+    };
+
+    /**  Set the solver \p solver_type on the given ksp */
+    void set_petsc_solver_type ( KSP &ksp, const SolverType &solver_type );
 
     /** To be Added */
     clock_t BuildBDCIndex(const vector <unsigned> &variable_to_be_solved);
@@ -122,6 +140,12 @@ private:
     /** To be Added */
     clock_t BuildFieldSplitIndex(const vector <unsigned> &variable_to_be_solved);
 
+    /** Build the velocity and pressure index sets of the Schur field split */
+    clock_t BuildSchurIndex();
+
+    /** Set the Schur complement field split, its factorization, the Schur preconditioner and the inner solvers on the pc of ksp */
+    void SetPetscSchurFieldSplit(KSP &ksp, PC &pc);
+
     // member data
 
     PC _pc;      ///< Preconditioner context
@@ -149,6 +173,14 @@ private:
     bool _Pmat_is_initialized;
     vector <unsigned> _block_type_range;
 
+    SchurPreconditioner _schurType;
+    vector <unsigned> _schurPressureIndex;
+    SolverType _schurInnerSolver;
+    PreconditionerType _schurInnerPreconditioner;
+    PetscInt _schurInnerMaxits;
+    vector< vector <PetscInt> > _is_schur_idx;
+    vector <IS> _is_schur;
+
 
     //vector < KSP*> _ksp_split;
     //vector< vector < PC > >  _pc_split;
@@ -194,6 +226,10 @@ inline FieldSplitPetscLinearEquationSolver::FieldSplitPetscLinearEquationSolver
     _NSchurVar=1;
     _standard_ASM=1;
     _overlap=0;
+    _schurType = NO_SCHUR;
+    _schurInnerSolver = GMRES;
+    _schurInnerPreconditioner = ILU_PRECOND;
+    _schurInnerMaxits = 2;
 
 }
 
@@ -210,6 +246,10 @@ inline FieldSplitPetscLinearEquationSolver::~FieldSplitPetscLinearEquationSolver
         ISDestroy(&_is_ovl[i]);
     }
 
+    for(unsigned i=0; i<_is_schur.size(); i++) {
+        ISDestroy(&_is_schur[i]);
+    }
+
 }
 
 } //end namespace femus
@@ -26,8 +26,10 @@
 #include "PetscPreconditioner.hpp"
 #include "PetscVector.hpp"
 #include "PetscMatrix.hpp"
+#include "Solution.hpp"
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 namespace femus {
 
@@ -106,6 +108,146 @@ namespace femus {
     return SearchTime;
   }
 
+// ================================================
+
+  bool GmresPetscLinearEquationSolver::SetAgglomeratedCoarseSolver(PC& pc, Mat& KK) {
+
+    if (_coarseDofsPerRank == 0 || _nprocs == 1) return false;
+
+    if (_preconditioner_type != MLU_PRECOND && _preconditioner_type != LU_PRECOND) return false;
+
+    PetscInt nrows, ncols;
+    MatGetSize(KK, &nrows, &ncols);
+
+    if (nrows >= static_cast<PetscInt>(_coarseDofsPerRank) * _nprocs) return false;
+
+    // number of active ranks in each redundant group, targeting _coarseDofsPerRank dofs per rank
+    int nActive = std::max(1, std::min(_nprocs, static_cast<int>(nrows / _coarseDofsPerRank)));
+    // one redundant copy for every nActive ranks, with the number of copies dividing the number of processes
+    int nGroups = _nprocs / nActive;
+    while (_nprocs % nGroups != 0) nGroups++;
+
+    int ierr = PCSetType(pc, (char*) PCREDUNDANT);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+    ierr = PCRedundantSetNumber(pc, nGroups);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+
+    KSP redksp;
+    ierr = PCRedundantGetKSP(pc, &redksp);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+    ierr = KSPSetType(redksp, (char*) KSPPREONLY);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+
+    PC redpc;
+    ierr = KSPGetPC(redksp, &redpc);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+    ierr = PCSetType(redpc, (char*) PCLU);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+
+    if (nGroups < _nprocs) {
+      ierr = PCFactorSetMatSolverPackage(redpc, MATSOLVERMUMPS);
+      CHKERRABORT(MPI_COMM_WORLD, ierr);
+    }
+
+    PetscReal zero = 1.e-16;
+    PCFactorSetZeroPivot(redpc, zero);
+    PCFactorSetShiftType(redpc, MAT_SHIFT_NONZERO);
+
+    std::cout << " Coarse level with " << nrows << " dofs agglomerated on " << nGroups
+              << " redundant group(s) of " << _nprocs / nGroups << " rank(s)" << std::endl;
+
+    return true;
+  }
+
+// ================================================
+
+  void GmresPetscLinearEquationSolver::SetNearNullSpace(Mat& Pmat) {
+
+    if (_preconditioner_type != GAMG_PRECOND || _RigidBodyModesIndex.size() == 0) return;
+
+    unsigned dim = _msh->GetDimension();
+
+    if (_RigidBodyModesIndex.size() != dim) {
+      std::cout << "Warning the rigid body modes need " << dim << " displacement variables, the near null space is not set" << std::endl;
+      return;
+    }
+
+    unsigned solType = _SolType[_SolPdeIndex[_RigidBodyModesIndex[0]]];
+    unsigned ownSize = _msh->_ownSize[solType][processor_id()];
+    unsigned offset = _msh->_dofOffset[solType][processor_id()];
+
+    // coordinates of the displacement dofs
+    vector < NumericVector* > coord(dim);
+    for (unsigned d = 0; d < dim; d++) {
+      coord[d] = NumericVector::build().release();
+      if (n_processors() == 1) {
+        coord[d]->init(_msh->_dofOffset[solType][_nprocs], ownSize, false, SERIAL);
+      }
+      else {
+        coord[d]->init(_msh->_dofOffset[solType][_nprocs], ownSize, false, PARALLEL);
+      }
+      coord[d]->matrix_mult(*_msh->_topology->_Sol[d], *_msh->GetQitoQjProjection(solType, 2));
+    }
+
+    // 2 translations + 1 rotation in 2D, 3 translations + 3 rotations in 3D
+    unsigned nModes = (dim == 2) ? 3 : 6;
+    vector < Vec > modes(nModes);
+    PetscInt nlocal, mlocal;
+    MatGetLocalSize(Pmat, &nlocal, &mlocal);
+    for (unsigned m = 0; m < nModes; m++) {
+      VecCreateMPI(MPI_COMM_WORLD, nlocal, PETSC_DETERMINE, &modes[m]);
+      VecSet(modes[m], 0.);
+    }
+
+    for (unsigned i = 0; i < ownSize; i++) {
+      PetscInt row[3];
+      PetscScalar x[3] = {0., 0., 0.};
+      for (unsigned d = 0; d < dim; d++) {
+        row[d] = KKoffset[_RigidBodyModesIndex[d]][processor_id()] + i;
+        x[d] = (*coord[d])(offset + i);
+        VecSetValue(modes[d], row[d], 1., INSERT_VALUES);
+      }
+      if (dim == 2) {
+        VecSetValue(modes[2], row[0], -x[1], INSERT_VALUES);
+        VecSetValue(modes[2], row[1],  x[0], INSERT_VALUES);
+      }
+      else {
+        VecSetValue(modes[3], row[0], -x[1], INSERT_VALUES);
+        VecSetValue(modes[3], row[1],  x[0], INSERT_VALUES);
+        VecSetValue(modes[4], row[1], -x[2], INSERT_VALUES);
+        VecSetValue(modes[4], row[2],  x[1], INSERT_VALUES);
+        VecSetValue(modes[5], row[0],  x[2], INSERT_VALUES);
+        VecSetValue(modes[5], row[2], -x[0], INSERT_VALUES);
+      }
+    }
+
+    // MatNullSpaceCreate requires an orthonormal basis: modified Gram-Schmidt
+    for (unsigned m = 0; m < nModes; m++) {
+      VecAssemblyBegin(modes[m]);
+      VecAssemblyEnd(modes[m]);
+      for (unsigned n = 0; n < m; n++) {
+        PetscScalar dot;
+        VecDot(modes[m], modes[n], &dot);
+        VecAXPY(modes[m], -dot, modes[n]);
+      }
+      VecNormalize(modes[m], NULL);
+    }
+
+    MatNullSpace nearNullSpace;
+    int ierr = MatNullSpaceCreate(MPI_COMM_WORLD, PETSC_FALSE, nModes, &modes[0], &nearNullSpace);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+    ierr = MatSetNearNullSpace(Pmat, nearNullSpace);
+    CHKERRABORT(MPI_COMM_WORLD, ierr);
+
+    MatNullSpaceDestroy(&nearNullSpace);
+    for (unsigned m = 0; m < nModes; m++) {
+      VecDestroy(&modes[m]);
+    }
+    for (unsigned d = 0; d < dim; d++) {
+      delete coord[d];
+    }
+  }
+
 // ================================================
 
   void GmresPetscLinearEquationSolver::solve(const vector <unsigned>& variable_to_be_solved, const bool& ksp_clean) {
@@ -294,6 +436,8 @@ namespace femus {
     MatZeroRows(_Pmat, _indexai[0].size(), &_indexai[0][0], 1.e100, 0, 0);
     _Pmat_is_initialized = true;
 
+    SetNearNullSpace(_Pmat);
+
     std::ostringstream levelName;
     levelName << "level-" << level;
 
@@ -305,10 +449,14 @@ namespace femus {
 
     ierr = KSPGetPC(subksp, &subpc);
 
-    PetscPreconditioner::set_petsc_preconditioner_type(this->_preconditioner_type, subpc);
-    PetscReal zero = 1.e-16;
-    PCFactorSetZeroPivot(subpc, zero);
-    PCFactorSetShiftType(subpc, MAT_SHIFT_NONZERO);
+    if (level > 0 || !SetAgglomeratedCoarseSolver(subpc, KK)) {
+      PetscPreconditioner::set_petsc_preconditioner_type(this->_preconditioner_type, subpc);
+      PetscReal zero = 1.e-16;
+      PCFactorSetZeroPivot(subpc, zero);
+      PCFactorSetShiftType(subpc, MAT_SHIFT_NONZERO);
+    }
+
+    if (level == 0) _coarseKsp = subksp;
 
     if (level < levelMax) {
       PetscVector* EPSp = static_cast< PetscVector* >(_EPS);
@@ -340,12 +488,60 @@ namespace femus {
 
   }
 
+  void GmresPetscLinearEquationSolver::PrintCoarseFactorizationStatistics() {
+
+    if (!_printCoarseFactorization || _coarseKsp == NULL) return;
+
+    if (_preconditioner_type != LU_PRECOND && _preconditioner_type != MLU_PRECOND && _preconditioner_type != SLU_PRECOND) return;
+
+    // the coarse solver has already been set up by the multigrid solve
+    PC pc;
+    KSPGetPC(_coarseKsp, &pc);
+
+    PetscBool isRedundant;
+    PetscObjectTypeCompare((PetscObject) pc, PCREDUNDANT, &isRedundant);
+    if (isRedundant) { // the factored matrix of the redundant copy
+      KSP redksp;
+      PCRedundantGetKSP(pc, &redksp);
+      KSPGetPC(redksp, &pc);
+    }
+
+    // not all the factorization packages provide the info of the factored matrix
+    PetscPushErrorHandler(PetscIgnoreErrorHandler, PETSC_NULL);
+    Mat F;
+    MatInfo info;
+    PetscErrorCode ierr = PCFactorGetMatrix(pc, &F);
+    if (!ierr) ierr = MatGetInfo(F, MAT_GLOBAL_SUM, &info);
+    PetscPopErrorHandler();
+
+    MPI_Comm comm;
+    PetscObjectGetComm((PetscObject) _coarseKsp, &comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    if (rank == 0) {
+      std::cout << "Coarse factorization";
+      if (isRedundant) std::cout << " (each redundant copy)";
+      if (!ierr) {
+        // the format of the memory does not change the state of std::cout
+        std::ostringstream memory;
+        memory << std::setprecision(2) << std::fixed << info.memory / 1048576.;
+        std::cout << "  NONZEROS: " << static_cast<long long>(info.nz_used) << "  MEMORY: " << memory.str() << " MB";
+      }
+      else {
+        std::cout << "  statistics not available for this factorization package";
+      }
+      std::cout << std::endl;
+    }
+  }
+
   void GmresPetscLinearEquationSolver::MGsolve(const bool ksp_clean) {
 
     if (ksp_clean) {
       PetscMatrix* KKp = static_cast< PetscMatrix* >(_KK);
       Mat KK = KKp->mat();
       KSPSetOperators(_ksp, KK, _Pmat);
+      this->set_petsc_solver_type(_ksp, _outer_solver_type);
 
       KSPSetTolerances(_ksp, _rtol, _abstol, _dtol, _maxits);
       KSPSetInitialGuessKnoll(_ksp, PETSC_TRUE);
@@ -426,6 +622,7 @@ namespace femus {
       // Set user-specified  solver and preconditioner types
       this->set_petsc_solver_type(_ksp);
 
+      SetNearNullSpace(Pmat);
 
 //       ierr = KSPSetOperators(_ksp, Amat, Pmat, SAME_PRECONDITIONER);		CHKERRABORT(MPI_COMM_WORLD,ierr);
       ierr = KSPSetOperators(_ksp, Amat, Pmat);
@@ -461,18 +658,20 @@ namespace femus {
 //       CHKERRABORT(MPI_COMM_WORLD,ierr);
 
       //PCSetType(_pc,PCREDISTRIBUTE);
-      PetscPreconditioner::set_petsc_preconditioner_type(this->_preconditioner_type, _pc);
-      PetscReal zero = 1.e-16;
-      PCFactorSetZeroPivot(_pc, zero);
-      PCFactorSetShiftType(_pc, MAT_SHIFT_NONZERO);
+      if (_msh->GetLevel() != 0 || !SetAgglomeratedCoarseSolver(_pc, Amat)) {
+        PetscPreconditioner::set_petsc_preconditioner_type(this->_preconditioner_type, _pc);
+        PetscReal zero = 1.e-16;
+        PCFactorSetZeroPivot(_pc, zero);
+        PCFactorSetShiftType(_pc, MAT_SHIFT_NONZERO);
+      }
     }
   }
 
 // ================================================
 
-  void GmresPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp) {
+  void GmresPetscLinearEquationSolver::set_petsc_solver_type(KSP& ksp, const SolverType& solver_type) {
     int ierr = 0;
-    switch (this->_solver_type) {
+    switch (solver_type) {
       case CG:
         ierr = KSPSetType(ksp, (char*) KSPCG);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
@@ -525,9 +724,21 @@ namespace femus {
         ierr = KSPSetType(ksp, (char*) KSPPREONLY);
         CHKERRABORT(MPI_COMM_WORLD, ierr);
         return;
+      case PIPECG:
+        ierr = KSPSetType(ksp, (char*) KSPPIPECG);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
+      case PIPEFGMRES:
+        ierr = KSPSetType(ksp, (char*) KSPPIPEFGMRES);
+        CHKERRABORT(MPI_COMM_WORLD, ierr);
+        return;
       default:
         std::cerr << "ERROR:  Unsupported PETSC Solver: "
-                  << this->_solver_type               << std::endl
+                  << solver_type                      << std::endl
                   << "Continuing with PETSC defaults" << std::endl;
     }
   }
@@ -60,6 +60,19 @@ public:
     _DirichletBCsHandlingMode = DirichletBCsHandlingMode;
   }
 
+  /** Gather the coarse direct solve on fewer ranks when the coarse matrix has less than dofs_per_rank dofs per process, 0 disables it */
+  void SetCoarseAgglomeration ( const unsigned &dofs_per_rank ) {
+    _coarseDofsPerRank = dofs_per_rank;
+  }
+
+  /** Enable the print of the nonzeros and memory of the coarse factorization after the multigrid setup */
+  void SetCoarseFactorizationStatistics ( const bool &print ) {
+    _printCoarseFactorization = print;
+  }
+
+  /** Print the nonzeros and memory of the coarse factorization, on the root of the coarse solver communicator */
+  void PrintCoarseFactorizationStatistics ();
+
   // Solvers ------------------------------------------------------
   // ========================================================
   /// Call the GMRES smoother-solver using the PetscLibrary.
@@ -67,10 +80,22 @@ public:
 
   // Setting --------------------------------------------
   ///  Set the user-specified solver stored in \p _solver_type
-  void set_petsc_solver_type ( KSP &ksp);
+  void set_petsc_solver_type ( KSP &ksp) {
+    set_petsc_solver_type ( ksp, this->_solver_type );
+  };
+
+  ///  Set the solver \p solver_type on the given ksp
+  void set_petsc_solver_type ( KSP &ksp, const SolverType &solver_type );
 
   clock_t BuildIndex ( const vector <unsigned> &variable_to_be_solved );
 
+  /** Attach the rigid body modes of the displacement variables as near null space of Pmat when GAMG is used */
+  void SetNearNullSpace ( Mat &Pmat );
+
+  /** Set a redundant direct solver on reduced subcommunicators if the coarse matrix is below the agglomeration threshold */
+  bool SetAgglomeratedCoarseSolver ( PC &pc, Mat &KK );
+
+
   /** @deprecated, remove soon */
   std::pair<unsigned int, double> solve ( SparseMatrix&  matrix_in,
                                           SparseMatrix&  precond_in,  NumericVector& solution_in,  NumericVector& rhs_in,
@@ -140,6 +165,9 @@ private:
   Mat _Pmat;
   bool _Pmat_is_initialized;
   unsigned int _DirichletBCsHandlingMode; //* 0 Penalty method,  1 Elimination method */
+  unsigned _coarseDofsPerRank;
+  bool _printCoarseFactorization;
+  KSP _coarseKsp;
 
 };
 
@@ -174,6 +202,10 @@ inline GmresPetscLinearEquationSolver::GmresPetscLinearEquationSolver ( const un
 
   _DirichletBCsHandlingMode = 0;
 
+  _coarseDofsPerRank = 0;
+  _printCoarseFactorization = false;
+  _coarseKsp = NULL;
+
 }
 
 // =============================================
@@ -30,6 +30,7 @@
 #include "LinearEquation.hpp"
 #include "MgSmootherEnum.hpp"
 #include "MgTypeEnum.hpp"
+#include "SchurPrecondEnum.hpp"
 
 #include <petscksp.h>
 
@@ -106,9 +107,26 @@ public:
         _solver_type = st;
     }
 
+    /** Sets the type of the outer Krylov solver wrapping the multigrid preconditioner. The Krylov smoothers make the
+     * multigrid preconditioner variable, so the only pipelined outer solver allowed is the flexible PIPEFGMRES */
+    void set_outer_solver_type (const SolverType st)  {
+        if (st == PIPECG || st == PGMRES) {
+          std::cout << "Warning PIPECG and PGMRES are not flexible, PIPEFGMRES is used as outer multigrid solver" << std::endl;
+          _outer_solver_type = PIPEFGMRES;
+        }
+        else {
+          _outer_solver_type = st;
+        }
+    }
+
     /** Sets the type of preconditioner to use. */
     void set_preconditioner_type (const PreconditionerType pct);
 
+    /** Sets the Pde indices of the displacement components used to build the rigid body near null space for GAMG */
+    void SetRigidBodyModesVariables (const vector <unsigned> &RigidBodyModesIndex) {
+        _RigidBodyModesIndex = RigidBodyModesIndex;
+    }
+
     /** Attaches a Preconditioner object to be used */
     void attach_preconditioner(Preconditioner * preconditioner);
 
@@ -147,6 +165,26 @@ public:
         std::cout<<"Warning SetNumberOfSchurVariables(const unsigned short &) is not available for this smoother\n";
     };
 
+    /** Set the dofs-per-rank threshold below which the coarse level is gathered on a subset of ranks */
+    virtual void SetCoarseAgglomeration(const unsigned &dofs_per_rank) {
+        std::cout<<"Warning SetCoarseAgglomeration(const unsigned &) is not available for this smoother\n";
+    };
+
+    /** Enable the print of the coarse factorization statistics */
+    virtual void SetCoarseFactorizationStatistics(const bool &print) {
+        std::cout<<"Warning SetCoarseFactorizationStatistics(const bool &) is not available for this smoother\n";
+    };
+
+    /** Print the coarse factorization statistics, if enabled */
+    virtual void PrintCoarseFactorizationStatistics() {};
+
+    /** Set a Schur complement field split with the Pde variables PressureIndex as second block */
+    virtual void SetSchurPreconditioner(const SchurPreconditioner &schurType, const vector <unsigned> &PressureIndex,
+                                        const SolverType &innerSolver, const PreconditionerType &innerPreconditioner,
+                                        const unsigned &innerMaxits) {
+        std::cout<<"Warning SetSchurPreconditioner(...) is not available for this smoother\n";
+    };
+
     /** To be Added */
     virtual void SetDirichletBCsHandling(const unsigned int &DirichletBCsHandlingMode) {
         std::cout<<"Warning SetDirichletBCsHandling(const unsigned int &) is not available for this smoother\n";
@@ -169,9 +207,15 @@ protected:
     /** Enum stating which type of iterative solver to use. */
     SolverType _solver_type;
 
+    /** Enum stating which type of Krylov solver to use as the outer multigrid solver. */
+    SolverType _outer_solver_type;
+
     /** Enum statitng with type of preconditioner to use. */
     PreconditionerType _preconditioner_type;
 
+    /** Pde indices of the displacement components spanning the rigid body modes */
+    vector <unsigned> _RigidBodyModesIndex;
+
     /** Holds the Preconditioner object to be used for the linear solves. */
     Preconditioner *_preconditioner;
 
@@ -190,6 +234,7 @@ protected:
 inline LinearEquationSolver::LinearEquationSolver(const unsigned &igrid, Mesh* other_msh) :
     LinearEquation(other_msh),
     _solver_type(GMRES),
+    _outer_solver_type(GMRES),
     _preconditioner(NULL),
     _is_initialized(false),
     same_preconditioner(false) {
@@ -117,6 +117,13 @@ double NumericVector::subset_linfty_norm (const std::set< int> & indices) {
 }
 
 
+// ============================================
+void NumericVector::l2_norms (const std::vector< NumericVector* > & vecs, std::vector< double > & norms) {
+  norms.resize(vecs.size());
+  for (unsigned i = 0; i < vecs.size(); i++) vecs[i]->l2_norm_begin();
+  for (unsigned i = 0; i < vecs.size(); i++) norms[i] = vecs[i]->l2_norm_end();
+}
+
 
 } //end namespace femus
 
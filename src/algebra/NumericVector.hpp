@@ -202,6 +202,17 @@ public:
   /// @returns the maximum absolute value of the
   virtual double linfty_norm () const = 0;
 
+  /// Starts the split-phase computation of the \f$l_2\f$-norm: all the begin calls
+  /// issued before the first matching end call are completed with a single global reduction
+  virtual void l2_norm_begin () const {}
+  /// Completes the computation started with l2_norm_begin and @returns the \f$l_2\f$-norm
+  virtual double l2_norm_end () const {
+    return l2_norm();
+  }
+
+  /// Computes the \f$l_2\f$-norms of the vectors \p vecs with a single global reduction
+  static void l2_norms (const std::vector< NumericVector* > & vecs, std::vector< double > & norms);
+
   /// @returns the \f$l_1\f$-norm of the vector, i.e.
   virtual double subset_l1_norm (const std::set< int> & indices);
   /// @returns the \f$l_2\f$-norm of the vector, i.e.
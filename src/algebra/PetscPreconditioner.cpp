@@ -181,6 +181,11 @@ void PetscPreconditioner::set_petsc_preconditioner_type
     CHKERRABORT(MPI_COMM_WORLD,ierr);
     break;
 
+  case GAMG_PRECOND:
+    ierr = PCSetType (pc, (char*) PCGAMG);
+    CHKERRABORT(MPI_COMM_WORLD,ierr);
+    break;
+
   case MG_PRECOND:
     ierr = PCSetType (pc, (char*) PCMG);
     CHKERRABORT(MPI_COMM_WORLD,ierr);
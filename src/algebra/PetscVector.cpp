@@ -85,6 +85,27 @@ double PetscVector::linfty_norm() const {
   return static_cast<double>(value);
 }
 
+// ============================================
+/// This function starts the split-phase computation of the \f$l_2\f$-norm
+void PetscVector::l2_norm_begin() const {
+  this->_restore_array();
+  assert(this->closed());
+  int ierr=0;
+  PetscReal value=0.;
+  ierr = VecNormBegin(_vec, NORM_2, &value);
+  CHKERRABORT(MPI_COMM_WORLD,ierr);
+}
+
+// ============================================
+/// This function completes the split-phase computation of the \f$l_2\f$-norm
+double PetscVector::l2_norm_end() const {
+  int ierr=0;
+  PetscReal value=0.;
+  ierr = VecNormEnd(_vec, NORM_2, &value);
+  CHKERRABORT(MPI_COMM_WORLD,ierr);
+  return static_cast<double>(value);
+}
+
 // =======================================
 NumericVector& PetscVector::operator += (const NumericVector& v) {
   this->_restore_array();
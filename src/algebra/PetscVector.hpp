@@ -167,6 +167,9 @@ public:
   double l2_norm () const;     ///< This function returns the \f$l_2\f$-norm of the vector
   double linfty_norm () const; ///< This function returns the maximum absolute value of the elements of this vector
 
+  void l2_norm_begin () const;       ///< This function starts the split-phase computation of the \f$l_2\f$-norm
+  double l2_norm_end () const;       ///< This function completes the split-phase computation of the \f$l_2\f$-norm
+
 
   int size () const;         ///< This function returns dimension of the vector
   int local_size() const;    ///< This function returns the local size of the vector (index_stop-index_start)
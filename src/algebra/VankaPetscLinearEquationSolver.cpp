@@ -507,6 +507,15 @@ namespace femus {
     case PREONLY:
       ierr = KSPSetType(ksp, (char*) KSPPREONLY);		CHKERRABORT(MPI_COMM_WORLD,ierr);
       return;
+    case PIPECG:
+      ierr = KSPSetType(ksp, (char*) KSPPIPECG);		CHKERRABORT(MPI_COMM_WORLD,ierr);
+      return;
+    case PGMRES:
+      ierr = KSPSetType(ksp, (char*) KSPPGMRES);		CHKERRABORT(MPI_COMM_WORLD,ierr);
+      return;
+    case PIPEFGMRES:
+      ierr = KSPSetType(ksp, (char*) KSPPIPEFGMRES);		CHKERRABORT(MPI_COMM_WORLD,ierr);
+      return;
     default:
       std::cerr << "ERROR:  Unsupported PETSC Solver: "
 		<< this->_solver_type               << std::endl
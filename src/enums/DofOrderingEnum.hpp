@@ -0,0 +1,10 @@
+#ifndef __femus_enums_DofOrderingEnum_hpp__
+#define __femus_enums_DofOrderingEnum_hpp__
+
+enum DofOrderingType {
+    NO_DOF_ORDERING=0,
+    RCM_DOF_ORDERING,
+    NESTED_DISSECTION_DOF_ORDERING
+};
+
+#endif
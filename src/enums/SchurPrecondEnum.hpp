@@ -0,0 +1,10 @@
+#ifndef __femus_enums_SchurPrecondEnum_hpp__
+#define __femus_enums_SchurPrecondEnum_hpp__
+
+enum SchurPreconditioner {
+    NO_SCHUR=0,
+    LSC_SCHUR,
+    SIMPLE_SCHUR
+};
+
+#endif
@@ -22,7 +22,12 @@ enum SolverType {
     CHEBYSHEV,
     LUMP,
     INVALID_SOLVER,
-    PREONLY
+    PREONLY,
+    /** pipelined solvers: PIPECG and PGMRES need a fixed preconditioner and are used only as smoothers,
+     *  PIPEFGMRES is flexible and can also wrap the multigrid preconditioner */
+    PIPECG,
+    PGMRES,
+    PIPEFGMRES
 };
 
 #endif
@@ -38,7 +38,10 @@ namespace femus {
     _maxAMRlevels(0),
     _AMRnorm(0),
     _AMRthreshold(0.01),
-    _SmootherType(smoother_type)
+    _SmootherType(smoother_type),
+    _outersolvertype(GMRES),
+    _schurType(NO_SCHUR),
+    _schurInnerMaxits(2)
   {
     _SparsityPattern.resize(0);
     _MGmatrixFineReuse = false;
@@ -180,9 +183,12 @@ namespace femus {
     double L2normRes;
     std::cout << std::endl;
 
+    vector <double> L2normResAll;
+    _solution[igridn]->GetResL2Norms(_SolSystemPdeIndex, L2normResAll);
+
     for (unsigned k = 0; k < _SolSystemPdeIndex.size(); k++) {
       unsigned indexSol = _SolSystemPdeIndex[k];
-      L2normRes       = _solution[igridn]->_Res[indexSol]->l2_norm();
+      L2normRes       = L2normResAll[k];
       std::cout << " ************ Level Max " << igridn + 1 << "  Linear Res  L2norm " << std::scientific << _ml_sol->GetSolutionName(indexSol) << " = " << L2normRes    << std::endl;
 
       if (L2normRes < _absolute_convergence_tolerance && conv == true) {
@@ -252,6 +258,7 @@ namespace femus {
       std::cout << std::endl << " ************ Linear iteration " << linearIterator + 1 << " ***********" << std::endl;
       bool ksp_clean = !linearIterator;
       _LinSolver[gridn - 1u]->MGsolve(ksp_clean);
+      if (ksp_clean) _LinSolver[0]->PrintCoarseFactorizationStatistics();
       _solution[gridn - 1u]->UpdateRes(_SolSystemPdeIndex, _LinSolver[gridn - 1u]->_RES, _LinSolver[gridn - 1u]->KKoffset);
       bool islinearconverged = IsLinearConverged(gridn - 1u);
 
@@ -424,6 +431,8 @@ namespace femus {
 
 
     _LinSolver[_gridn]->set_solver_type(_finegridsolvertype);
+    _LinSolver[_gridn]->set_outer_solver_type(_outersolvertype);
+    _LinSolver[_gridn]->SetRigidBodyModesVariables(_RigidBodyModesIndex);
     _LinSolver[_gridn]->set_tolerances(_rtol, _atol, _divtol, _maxits);
     _LinSolver[_gridn]->set_preconditioner_type(_finegridpreconditioner);
     _LinSolver[_gridn]->SetDirichletBCsHandling(_DirichletBCsHandlingMode);
@@ -440,6 +449,10 @@ namespace femus {
       _LinSolver[_gridn]->SetNumberOfSchurVariables(_NSchurVar);
     }
 
+    if (_schurType != NO_SCHUR) {
+      _LinSolver[_gridn]->SetSchurPreconditioner(_schurType, _schurPressureIndex, _schurInnerSolver, _schurInnerPreconditioner, _schurInnerMaxits);
+    }
+
     _gridn++;
   }
 
@@ -655,6 +668,99 @@ namespace femus {
 
   // ********************************************
 
+  void LinearImplicitSystem::SetOuterSolver(const SolverType outersolvertype) {
+    _outersolvertype = outersolvertype;
+
+    for (unsigned i = 0; i < _gridn; i++) {
+      _LinSolver[i]->set_outer_solver_type(_outersolvertype);
+    }
+  }
+
+  // ********************************************
+
+  void LinearImplicitSystem::SetCoarseAgglomeration(const unsigned& dofs_per_rank) {
+    _LinSolver[0]->SetCoarseAgglomeration(dofs_per_rank);
+  }
+
+  // ********************************************
+
+  void LinearImplicitSystem::SetCoarseFactorizationStatistics(const bool& print) {
+    _LinSolver[0]->SetCoarseFactorizationStatistics(print);
+  }
+
+  // ********************************************
+
+  void LinearImplicitSystem::SetPreconditionerCoarseGrid(const PreconditionerType coarsegridpreconditioner) {
+    _LinSolver[0]->set_preconditioner_type(coarsegridpreconditioner);
+
+    if (coarsegridpreconditioner == AMG_PRECOND || coarsegridpreconditioner == GAMG_PRECOND) {
+      _LinSolver[0]->set_solver_type(GMRES);
+    }
+  }
+
+  // ********************************************
+
+  void LinearImplicitSystem::SetRigidBodyModesVariables(const std::vector < std::string >& displacement) {
+
+    _RigidBodyModesIndex.resize(displacement.size());
+
+    for (unsigned j = 0; j < displacement.size(); j++) {
+      unsigned varind = _ml_sol->GetIndex(displacement[j].c_str());
+
+      for (unsigned i = 0; i < _SolSystemPdeIndex.size(); i++) {
+        if (_SolSystemPdeIndex[i] == varind) {
+          _RigidBodyModesIndex[j] = i;
+          break;
+        }
+
+        if (_SolSystemPdeIndex.size() - 1u == i) {
+          std::cout << "Error! The variable " << displacement[j] << " cannot be used for the rigid body modes"
+                    << " because it is not included in the solution variable set." << std::endl;
+          std::exit(0);
+        }
+      }
+    }
+
+    for (unsigned i = 0; i < _gridn; i++) {
+      _LinSolver[i]->SetRigidBodyModesVariables(_RigidBodyModesIndex);
+    }
+  }
+
+  // ********************************************
+
+  void LinearImplicitSystem::SetSchurPreconditioner(const SchurPreconditioner schurType, const std::vector < std::string >& pressure,
+      const SolverType innerSolver, const PreconditionerType innerPreconditioner, const unsigned innerMaxits) {
+
+    _schurType = schurType;
+    _schurInnerSolver = innerSolver;
+    _schurInnerPreconditioner = innerPreconditioner;
+    _schurInnerMaxits = innerMaxits;
+    _schurPressureIndex.resize(pressure.size());
+
+    for (unsigned j = 0; j < pressure.size(); j++) {
+      unsigned varind = _ml_sol->GetIndex(pressure[j].c_str());
+
+      for (unsigned i = 0; i < _SolSystemPdeIndex.size(); i++) {
+        if (_SolSystemPdeIndex[i] == varind) {
+          _schurPressureIndex[j] = i;
+          break;
+        }
+
+        if (_SolSystemPdeIndex.size() - 1u == i) {
+          std::cout << "Error! The variable " << pressure[j] << " cannot be used as Schur complement variable"
+                    << " because it is not included in the solution variable set." << std::endl;
+          std::exit(0);
+        }
+      }
+    }
+
+    for (unsigned i = 1; i < _gridn; i++) {
+      _LinSolver[i]->SetSchurPreconditioner(_schurType, _schurPressureIndex, _schurInnerSolver, _schurInnerPreconditioner, _schurInnerMaxits);
+    }
+  }
+
+  // ********************************************
+
   void LinearImplicitSystem::SetPreconditionerFineGrids(const PreconditionerType finegridpreconditioner) {
     _finegridpreconditioner = finegridpreconditioner;
 
@@ -131,6 +131,27 @@ public:
     /** Set the Ksp smoother solver on the fine grids. At the coarse solver we always use the LU (Mumps) direct solver */
     void SetSolverFineGrids(const SolverType solvertype);
 
+    /** Set the outer Krylov solver of the multigrid cycle (GMRES by default, PIPEFGMRES hides the global reductions; PIPECG/PGMRES fall back to PIPEFGMRES) */
+    void SetOuterSolver(const SolverType outersolvertype);
+
+    /** Gather the coarse direct solve on a subset of ranks when it has less than dofs_per_rank dofs per process (0 = all ranks) */
+    void SetCoarseAgglomeration(const unsigned &dofs_per_rank);
+
+    /** Print the nonzeros and memory of the coarse direct factorization after the first multigrid iteration (off by default) */
+    void SetCoarseFactorizationStatistics(const bool &print);
+
+    /** Set the preconditioner of the coarse grid solver, MLU (Mumps) by default. With AMG_PRECOND (hypre) or GAMG_PRECOND the coarse level is solved by GMRES */
+    void SetPreconditionerCoarseGrid(const PreconditionerType coarsegridpreconditioner);
+
+    /** Set the displacement variables whose rigid body modes are given to GAMG as near null space */
+    void SetRigidBodyModesVariables(const std::vector < std::string > &displacement);
+
+    /** Set a Schur complement field split on the fine grids (FieldSplit smoother): LSC_SCHUR or SIMPLE_SCHUR with the pressure variables as second block.
+     * The inner solvers of the splits do at most innerMaxits iterations in each outer iteration */
+    void SetSchurPreconditioner(const SchurPreconditioner schurType, const std::vector < std::string > &pressure,
+                                const SolverType innerSolver = GMRES, const PreconditionerType innerPreconditioner = ILU_PRECOND,
+                                const unsigned innerMaxits = 2);
+
     /** Set the preconditioner for the Ksp smoother solver on the fine grids */
     void SetPreconditionerFineGrids(const PreconditionerType preconditioner_type);
 
@@ -215,6 +236,7 @@ protected:
     vector <unsigned> _VariablesToBeSolvedIndex;
 
     SolverType _finegridsolvertype;
+    SolverType _outersolvertype;
     unsigned int _DirichletBCsHandlingMode;
     double _rtol,_atol,_divtol,_maxits;
     PreconditionerType _finegridpreconditioner;
@@ -234,6 +256,14 @@ protected:
 
     vector <bool> _SparsityPattern;
 
+    vector <unsigned> _RigidBodyModesIndex;
+
+    SchurPreconditioner _schurType;
+    vector <unsigned> _schurPressureIndex;
+    SolverType _schurInnerSolver;
+    PreconditionerType _schurInnerPreconditioner;
+    unsigned _schurInnerMaxits;
+
     /** Solves the system. */
     virtual void solve (const MgSmootherType& mgSmootherType = MULTIPLICATIVE);
 
@@ -56,9 +56,12 @@ namespace femus {
     double L2normEps;
     std::cout << std::endl;
 
+    vector <double> L2normEpsAll;
+    _solution[igridn]->GetEpsL2Norms(_SolSystemPdeIndex, L2normEpsAll);
+
     for (unsigned k = 0; k < _SolSystemPdeIndex.size(); k++) {
       unsigned indexSol = _SolSystemPdeIndex[k];
-      L2normEps    = _solution[igridn]->_Eps[indexSol]->l2_norm();
+      L2normEps    = L2normEpsAll[k];
       std::cout << " ********* Level Max " << igridn + 1 << " Nonlinear Eps L2norm" << std::scientific << _ml_sol->GetSolutionName(indexSol) << " = " << L2normEps << std::endl;
 
       if (L2normEps < _max_nonlinear_convergence_tolerance && conv == true) {
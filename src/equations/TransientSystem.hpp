@@ -110,6 +110,17 @@ public:
         return _time;
     };
 
+    /** Get the time step */
+    unsigned GetTimeStep() const {
+        return _time_step;
+    };
+
+    /** Set the time and the time step, to restart from a checkpoint */
+    void SetTime(const double time, const unsigned time_step) {
+        _time = time;
+        _time_step = time_step;
+    };
+
 protected:
 
     double _dt;
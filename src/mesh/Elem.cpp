@@ -22,6 +22,7 @@
 #include <cstring>
 #include <iostream>
 #include <assert.h>
+#include <algorithm>
 
 #include "Elem.hpp"
 #include "GeomElTypeEnum.hpp"
@@ -269,6 +270,73 @@ void elem::ReorderMeshNodes( const std::vector < unsigned > &nodeMapping){
 }
 
 
+/**
+ * Write the coarse level arrays as contiguous binary blocks. The vertices and the faces of each element are packed
+ * according to its type, independently of the element strides in memory, that change with ReorderMeshElements
+ **/
+void elem::WriteCheckpoint( std::ostream &out ) const {
+  out.write( (const char *) &_nel, sizeof(unsigned) );
+  out.write( (const char *) &_nvt, sizeof(unsigned) );
+  out.write( (const char *) &_ngroup, sizeof(unsigned) );
+  out.write( (const char *) &_nelf, sizeof(unsigned) );
+  out.write( (const char *) _nelt, 6 * sizeof(unsigned) );
+  out.write( (const char *) _elementType, _nel * sizeof(short unsigned) );
+  out.write( (const char *) _elementGroup, _nel * sizeof(short unsigned) );
+  out.write( (const char *) _elementMaterial, _nel * sizeof(short unsigned) );
+
+  std::vector < unsigned > kvert;
+  std::vector < int > kel;
+  for(unsigned iel = 0; iel < _nel; iel++){
+    kvert.insert( kvert.end(), _kvert[iel], _kvert[iel] + NVE[_elementType[iel]][2] );
+    kel.insert( kel.end(), _kel[iel], _kel[iel] + NFC[_elementType[iel]][1] );
+  }
+  out.write( (const char *) &kvert[0], kvert.size() * sizeof(unsigned) );
+  out.write( (const char *) &kel[0], kel.size() * sizeof(int) );
+}
+
+/**
+ * Read the coarse level arrays written by WriteCheckpoint, the elem has to be built with the same number of elements.
+ * The packed vertices and faces are unpacked in the element strides of the coarse elem constructor
+ **/
+void elem::ReadCheckpoint( std::istream &in ) {
+  unsigned nel;
+  in.read( (char *) &nel, sizeof(unsigned) );
+  if( nel != _nel ){
+    cout << "Error: the mesh checkpoint has " << nel << " elements, while " << _nel << " are expected" << endl;
+    abort();
+  }
+  in.read( (char *) &_nvt, sizeof(unsigned) );
+  in.read( (char *) &_ngroup, sizeof(unsigned) );
+  in.read( (char *) &_nelf, sizeof(unsigned) );
+  in.read( (char *) _nelt, 6 * sizeof(unsigned) );
+  in.read( (char *) _elementType, _nel * sizeof(short unsigned) );
+  in.read( (char *) _elementGroup, _nel * sizeof(short unsigned) );
+  in.read( (char *) _elementMaterial, _nel * sizeof(short unsigned) );
+
+  unsigned kvertSize = 0;
+  unsigned kelSize = 0;
+  for(unsigned iel = 0; iel < _nel; iel++){
+    kvertSize += NVE[_elementType[iel]][2];
+    kelSize += NFC[_elementType[iel]][1];
+  }
+  std::vector < unsigned > kvert(kvertSize);
+  std::vector < int > kel(kelSize);
+  in.read( (char *) &kvert[0], kvertSize * sizeof(unsigned) );
+  in.read( (char *) &kel[0], kelSize * sizeof(int) );
+
+  unsigned kvertOffset = 0;
+  unsigned kelOffset = 0;
+  for(unsigned iel = 0; iel < _nel; iel++){
+    unsigned nve = NVE[_elementType[iel]][2];
+    unsigned nfc = NFC[_elementType[iel]][1];
+    std::copy( kvert.begin() + kvertOffset, kvert.begin() + kvertOffset + nve, _kvert[iel] );
+    std::copy( kel.begin() + kelOffset, kel.begin() + kelOffset + nfc, _kel[iel] );
+    kvertOffset += nve;
+    kelOffset += nfc;
+  }
+}
+
+
 elem::~elem() {
     delete [] _kvertMemory;
     delete [] _kvert;
@@ -571,19 +639,38 @@ unsigned elem::GetIndex(const char name[]) const {
 }
 
 
-void elem::AllocateNodeRegion() {
+void elem::AllocateNodeRegion(const unsigned &offset, const unsigned &ownSize, const std::vector < int > &ghostNodes) {
+  if(_nodeRegionFlag) delete [] _nodeRegion;
   _nodeRegionFlag=1;
-  _nodeRegion=new bool [_nvt];
-  for (int i=0; i<_nvt; i++) _nodeRegion[i]=0;
+  _nodeRegionOffset = offset;
+  _nodeRegionOwnSize = ownSize;
+  _nodeRegionGhost.assign(ghostNodes.begin(), ghostNodes.end());
+  std::sort(_nodeRegionGhost.begin(), _nodeRegionGhost.end());
+
+  unsigned size = _nodeRegionOwnSize + _nodeRegionGhost.size();
+  _nodeRegion=new bool [size];
+  for (unsigned i=0; i<size; i++) _nodeRegion[i]=0;
   // 0 means Fluid - 1 means Solid  ==> Solid wins on Fluid on Interface nodes
 }
 
+unsigned elem::GetNodeRegionIndex(const unsigned &jnode) const {
+  if( jnode >= _nodeRegionOffset && jnode < _nodeRegionOffset + _nodeRegionOwnSize ) {
+    return jnode - _nodeRegionOffset;
+  }
+  std::vector < unsigned >::const_iterator it = std::lower_bound(_nodeRegionGhost.begin(), _nodeRegionGhost.end(), jnode);
+  if( it == _nodeRegionGhost.end() || *it != jnode ) {
+    std::cout << "Error! The region of node " << jnode << " is not stored on this process" << std::endl;
+    abort();
+  }
+  return _nodeRegionOwnSize + (it - _nodeRegionGhost.begin());
+}
+
 bool elem::GetNodeRegion(const unsigned &jnode) const {
-  return _nodeRegion[jnode];
+  return _nodeRegion[GetNodeRegionIndex(jnode)];
 }
 
 void  elem::SetNodeRegion(const unsigned &jnode, const bool &value) {
-  _nodeRegion[jnode]=value;
+  _nodeRegion[GetNodeRegionIndex(jnode)]=value;
 }
 
 void elem::AllocateChildrenElement(const unsigned &refindex, const std::vector < double > &localizedAmrVector){
@@ -17,6 +17,7 @@
 #define __femus_mesh_Elem_hpp__
 
 #include <vector>
+#include <iostream>
 
 namespace femus {
 
@@ -45,6 +46,10 @@ public:
     // reorder the nodes according to the new node mapping
     void ReorderMeshNodes( const std::vector < unsigned > &nodeMapping);
 
+    // write/read the coarse element arrays to/from a binary mesh checkpoint
+    void WriteCheckpoint( std::ostream &out ) const;
+    void ReadCheckpoint( std::istream &in );
+
 
     /** To be Added */
     unsigned GetMeshDof(const unsigned iel,const unsigned &inode,const unsigned &type)const;
@@ -160,14 +165,15 @@ public:
     /** To be Added */
     void SetNumberElementFather(const unsigned &value);
 
-    /** To be Added */
+    /** Fluid (0) or solid (1) region of the node jnode, that has to be owned or a ghost of this process */
     bool GetNodeRegion(const unsigned &jnode) const;
 
-    /** To be Added */
+    /** Set the region of the owned or ghost node jnode */
     void SetNodeRegion(const unsigned &jnode, const bool &value);
 
-    /** To be Added */
-    void AllocateNodeRegion();
+    /** Allocate the node regions only for the ownSize nodes starting at offset and the not owned nodes ghostNodes
+     *  used by this process (node halo and prolongation nodes) */
+    void AllocateNodeRegion(const unsigned &offset, const unsigned &ownSize, const std::vector < int > &ghostNodes);
 
     /** To be Added */
     void AllocateChildrenElement(const unsigned &ref_index, const std::vector < double > &localizedAmrVector);
@@ -213,8 +219,14 @@ private:
     unsigned _nelr,_nelrt[6];
     unsigned _ngroup;
 
+    /** Position of the owned or ghost node jnode in _nodeRegion */
+    unsigned GetNodeRegionIndex(const unsigned &jnode) const;
+
     bool *_nodeRegion;
     bool  _nodeRegionFlag;
+    unsigned _nodeRegionOffset;
+    unsigned _nodeRegionOwnSize;
+    std::vector < unsigned > _nodeRegionGhost;
     bool *_isFatherElementRefined; //element
     unsigned _nelf;
 
@@ -19,7 +19,10 @@
 
 //C++ include
 #include "cstdio"
+#include "cstdlib"
+#include "cstring"
 #include "fstream"
+#include "vector"
 
 
 namespace femus {
@@ -57,53 +60,171 @@ const unsigned GambitIO::GambitToFemusFaceIndex[N_GEOM_ELS][MAX_EL_N_FACES]=
   };
 
 
+// The whole neutral file is loaded in a single buffer and parsed in place with the helpers below,
+// which replace the formatted stream extraction of each token
+
+static bool IsBlank(const char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static void SkipBlanks(const char *buffer, size_t &pos) {
+  while (IsBlank(buffer[pos])) pos++;
+}
+
+/** Skip n blank separated tokens */
+static void SkipTokens(const char *buffer, size_t &pos, const unsigned n) {
+  for (unsigned i=0; i<n; i++) {
+    SkipBlanks(buffer,pos);
+    while (buffer[pos] != '\0' && !IsBlank(buffer[pos])) pos++;
+  }
+}
+
+/** Move pos after the next whole token equal to token, return false if not found */
+static bool FindToken(const char *buffer, size_t &pos, const char *token) {
+  const size_t length = strlen(token);
+  const char *p = buffer + pos;
+  while ((p = strstr(p, token)) != NULL) {
+    if ((p == buffer || IsBlank(p[-1])) && (p[length] == '\0' || IsBlank(p[length]))) {
+      pos = (p - buffer) + length;
+      return true;
+    }
+    p += length;
+  }
+  return false;
+}
+
+/** Check that the next token is equal to token */
+static bool CheckToken(const char *buffer, size_t &pos, const char *token) {
+  SkipBlanks(buffer,pos);
+  const size_t length = strlen(token);
+  bool match = (strncmp(buffer + pos, token, length) == 0 &&
+                (buffer[pos + length] == '\0' || IsBlank(buffer[pos + length])));
+  SkipTokens(buffer,pos,1);
+  return match;
+}
+
+static int ParseInt(const char *buffer, size_t &pos) {
+  SkipBlanks(buffer,pos);
+  bool negative = false;
+  if (buffer[pos] == '-' || buffer[pos] == '+') {
+    negative = (buffer[pos] == '-');
+    pos++;
+  }
+  int value = 0;
+  while (buffer[pos] >= '0' && buffer[pos] <= '9') {
+    value = 10 * value + (buffer[pos] - '0');
+    pos++;
+  }
+  // integers written in floating point notation
+  if (buffer[pos] == '.') SkipTokens(buffer,pos,1);
+  return (negative) ? -value : value;
+}
+
+/** Exact parsing when the mantissa has at most 15 digits and the power of ten is exact, strtod otherwise */
+static double ParseDouble(const char *buffer, size_t &pos) {
+  static const double exactPow10[23] = {1.e0, 1.e1, 1.e2, 1.e3, 1.e4, 1.e5, 1.e6, 1.e7, 1.e8, 1.e9, 1.e10, 1.e11,
+                                        1.e12, 1.e13, 1.e14, 1.e15, 1.e16, 1.e17, 1.e18, 1.e19, 1.e20, 1.e21, 1.e22};
+  SkipBlanks(buffer,pos);
+  const size_t start = pos;
+  bool negative = false;
+  if (buffer[pos] == '-' || buffer[pos] == '+') {
+    negative = (buffer[pos] == '-');
+    pos++;
+  }
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  while (buffer[pos] >= '0' && buffer[pos] <= '9') {
+    if (mantissa != 0 || buffer[pos] != '0') digits++;
+    mantissa = 10 * mantissa + (buffer[pos] - '0');
+    pos++;
+  }
+  if (buffer[pos] == '.') {
+    pos++;
+    while (buffer[pos] >= '0' && buffer[pos] <= '9') {
+      if (mantissa != 0 || buffer[pos] != '0') digits++;
+      mantissa = 10 * mantissa + (buffer[pos] - '0');
+      exponent--;
+      pos++;
+    }
+  }
+  if (buffer[pos] == 'e' || buffer[pos] == 'E') {
+    pos++;
+    exponent += ParseInt(buffer,pos);
+  }
+  if (digits > 15 || exponent < -22 || exponent > 22) {
+    char *last;
+    double value = strtod(buffer + start, &last);
+    pos = last - buffer;
+    return value;
+  }
+  double value = static_cast<double>(mantissa);
+  value = (exponent < 0) ? value / exactPow10[-exponent] : value * exactPow10[exponent];
+  return (negative) ? -value : value;
+}
+
+
 void GambitIO::read(const std::string& name, vector < vector < double> > &coords, const double Lref, std::vector<bool> &type_elem_flag) {
 
   Mesh& mesh = GetMesh();
 
-  std::ifstream inf;
-  std::string str2;
   unsigned ngroup;
   unsigned nbcd;
   unsigned dim;
-  double x,y,z;
   unsigned nvt;
   unsigned nel;
 
   mesh.SetLevel(0);
-  // read control data ******************** A
-  inf.open(name.c_str());
+
+  // load the file ************************
+  std::ifstream inf(name.c_str(), std::ios::in | std::ios::binary);
   if (!inf) {
     std::cout<<"Generic-mesh file "<< name << " can not read parameters\n";
     exit(0);
   }
-  str2="0";
-  while (str2.compare("NDFVL") != 0) inf >> str2;
-  inf >> nvt >> nel >>  ngroup >> nbcd >> dim >> str2 ;
+  inf.seekg(0, std::ios::end);
+  size_t fileSize = inf.tellg();
+  inf.seekg(0, std::ios::beg);
+  std::vector < char > fileBuffer(fileSize + 1);
+  inf.read(&fileBuffer[0], fileSize);
+  inf.close();
+  fileBuffer[fileSize] = '\0';
+  const char *buffer = &fileBuffer[0];
+  size_t pos;
+
+  // read control data ******************** A
+  pos = 0;
+  if (!FindToken(buffer,pos,"NDFVL")) {
+    std::cout<<"error control data mesh"<<std::endl;
+    exit(0);
+  }
+  nvt = ParseInt(buffer,pos);
+  nel = ParseInt(buffer,pos);
+  ngroup = ParseInt(buffer,pos);
+  nbcd = ParseInt(buffer,pos);
+  dim = ParseInt(buffer,pos);
+  SkipTokens(buffer,pos,1);
   mesh.SetDimension(dim);
   mesh.SetNumberOfElements(nel);
   mesh.SetNumberOfNodes(nvt);
-  inf >> str2;
-  if (str2.compare("ENDOFSECTION") != 0) {
+  if (!CheckToken(buffer,pos,"ENDOFSECTION")) {
     std::cout<<"error control data mesh"<<std::endl;
     exit(0);
   }
-//   std::cout << "***************" << _dimension << std::endl;
-  inf.close();
   // end read control data **************** A
+
   // read ELEMENT/cell ******************** B
-  inf.open(name.c_str());
-  if (!inf) {
+  pos = 0;
+  if (!FindToken(buffer,pos,"ELEMENTS/CELLS")) {
     std::cout<<"Generic-mesh file "<< name << " cannot read elements\n";
     exit(0);
   }
   mesh.el= new elem(nel);
-  while (str2.compare("ELEMENTS/CELLS") != 0) inf >> str2;
-  inf >> str2;
+  SkipTokens(buffer,pos,1);  // 2.0.4
   for (unsigned iel=0; iel<nel; iel++) {
     mesh.el->SetElementGroup(iel,1);
-    unsigned nve;
-    inf >> str2 >> str2 >> nve;
+    SkipTokens(buffer,pos,2);
+    unsigned nve = ParseInt(buffer,pos);
     if (nve==27) {
       type_elem_flag[0]=type_elem_flag[3]=true;
       mesh.el->AddToElementNumber(1,"Hex");
@@ -134,123 +255,93 @@ void GambitIO::read(const std::string& name, vector < vector < double> > &coords
       std::cout<<"Error! Use a second order discretization"<<std::endl;
       exit(0);
     }
+    const unsigned *femusIndex = GambitIO::GambitToFemusVertexIndex[mesh.el->GetElementType(iel)];
     for (unsigned i=0; i<nve; i++) {
-      unsigned inode=GambitIO::GambitToFemusVertexIndex[mesh.el->GetElementType(iel)][i];
-      double value;
-      inf>>value;
-      mesh.el->SetElementVertexIndex(iel,inode,value);
+      mesh.el->SetElementVertexIndex(iel,femusIndex[i],ParseInt(buffer,pos));
     }
   }
-  inf >> str2;
-  if (str2.compare("ENDOFSECTION") != 0) {
+  if (!CheckToken(buffer,pos,"ENDOFSECTION")) {
     std::cout<<"error element data mesh"<<std::endl;
     exit(0);
   }
-  inf.close();
-
   // end read  ELEMENT/CELL **************** B
 
   // read NODAL COORDINATES **************** C
-  inf.open(name.c_str());
-  if (!inf) {
+  pos = 0;
+  if (!FindToken(buffer,pos,"COORDINATES")) {
     std::cout<<"Generic-mesh file "<< name << " cannot read nodes\n";
     exit(0);
   }
-  while (str2.compare("COORDINATES") != 0) inf >> str2;
-  inf >> str2;  // 2.0.4
+  SkipTokens(buffer,pos,1);  // 2.0.4
   coords[0].resize(nvt);
   coords[1].resize(nvt);
   coords[2].resize(nvt);
 
-  if (mesh.GetDimension()==3) {
-    for (unsigned j=0; j<nvt; j++) {
-      inf >> str2 >> x >> y >> z;
-      coords[0][j] = x/Lref;
-      coords[1][j] = y/Lref;
-      coords[2][j] = z/Lref;
-    }
-  }
-
-  else if (mesh.GetDimension()==2) {
-    for (unsigned j=0; j<nvt; j++) {
-      inf >> str2 >> x >> y;
-      coords[0][j] = x/Lref;
-      coords[1][j] = y/Lref;
-      coords[2][j] = 0.;
-    }
-  }
-
-  else if (mesh.GetDimension()==1) {
-    for (unsigned j=0; j<nvt; j++) {
-      inf >> str2 >> x;
-      coords[0][j] = x/Lref;
-      coords[1][j]=0.;
-      coords[2][j]=0.;
+  for (unsigned j=0; j<nvt; j++) {
+    SkipTokens(buffer,pos,1);
+    for (unsigned k=0; k<3; k++) {
+      coords[k][j] = (k < mesh.GetDimension()) ? ParseDouble(buffer,pos)/Lref : 0.;
     }
   }
-  inf >> str2; // "ENDOFSECTION"
-  if (str2.compare("ENDOFSECTION") != 0) {
+  if (!CheckToken(buffer,pos,"ENDOFSECTION")) {
     std::cout<<"error node data mesh 1"<<std::endl;
     exit(0);
   }
-  inf.close();
   // end read NODAL COORDINATES ************* C
 
   // read GROUP **************** E
-  inf.open(name.c_str());
-  if (!inf) {
-    std::cout<<"Generic-mesh file "<< name << " cannot read group\n";
-    exit(0);
-  }
+  pos = 0;
   mesh.el->SetElementGroupNumber(ngroup);
   for (unsigned k=0; k<ngroup; k++) {
-    int ngel;
-    int gr_name;
-    int gr_mat;
-    while (str2.compare("GROUP:") != 0) inf >> str2;
-    inf >> str2 >> str2 >> ngel >> str2 >> gr_mat >>str2 >> str2 >>gr_name>> str2;
+    if (!FindToken(buffer,pos,"GROUP:")) {
+      std::cout<<"Generic-mesh file "<< name << " cannot read group\n";
+      exit(0);
+    }
+    SkipTokens(buffer,pos,2);
+    int ngel = ParseInt(buffer,pos);
+    SkipTokens(buffer,pos,1);
+    int gr_mat = ParseInt(buffer,pos);
+    SkipTokens(buffer,pos,2);
+    int gr_name = ParseInt(buffer,pos);
+    SkipTokens(buffer,pos,1);
     for (int i=0; i<ngel; i++) {
-      int iel;
-      inf >> iel;
+      int iel = ParseInt(buffer,pos);
       mesh.el->SetElementGroup(iel-1,gr_name);
       mesh.el->SetElementMaterial(iel-1,gr_mat);
     }
-    inf >> str2;
-    if (str2.compare("ENDOFSECTION") != 0) {
+    if (!CheckToken(buffer,pos,"ENDOFSECTION")) {
       std::cout<<"error group data mesh"<<std::endl;
       exit(0);
     }
   }
-  inf.close();
   // end read GROUP **************** E
 
   // read boundary **************** D
-  inf.open(name.c_str());
-  if (!inf) {
-    std::cout<<"Generic-mesh file "<< name << " cannot read boudary\n";
-    exit(0);
-  }
+  pos = 0;
   for (unsigned k=0; k<nbcd; k++) {
-    while (str2.compare("CONDITIONS") != 0) inf >> str2;
-    inf >> str2;
-    int value;
-    unsigned nface;
-    inf >>value>>str2>>nface>>str2>>str2;
+    if (!FindToken(buffer,pos,"CONDITIONS")) {
+      std::cout<<"Generic-mesh file "<< name << " cannot read boudary\n";
+      exit(0);
+    }
+    SkipTokens(buffer,pos,1);
+    int value = ParseInt(buffer,pos);
+    SkipTokens(buffer,pos,1);
+    unsigned nface = ParseInt(buffer,pos);
+    SkipTokens(buffer,pos,2);
     value=-value-1;
     for (unsigned i=0; i<nface; i++) {
-      unsigned iel,iface;
-      inf>>iel>>str2>>iface;
+      unsigned iel = ParseInt(buffer,pos);
+      SkipTokens(buffer,pos,1);
+      unsigned iface = ParseInt(buffer,pos);
       iel--;
       iface=GambitIO::GambitToFemusFaceIndex[mesh.el->GetElementType(iel)][iface-1u];
       mesh.el->SetFaceElementIndex(iel,iface,value);
     }
-    inf >> str2;
-    if (str2.compare("ENDOFSECTION") != 0) {
+    if (!CheckToken(buffer,pos,"ENDOFSECTION")) {
       std::cout<<"error boundary data mesh"<<std::endl;
       exit(0);
     }
   }
-  inf.close();
   // end read boundary **************** D
 
 };
@@ -22,6 +22,11 @@
 #include "GambitIO.hpp"
 #include "SalomeIO.hpp"
 #include "NumericVector.hpp"
+#include "FemusConfig.hpp"
+
+#ifdef HAVE_METIS
+  #include "metis.h"
+#endif
 
 // C++ includes
 #include <iostream>
@@ -30,6 +35,7 @@
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <sstream>
 
 
 namespace femus {
@@ -41,6 +47,10 @@ using std::sort;
 using std::map;
 
 bool Mesh::_IsUserRefinementFunctionDefined = false;
+bool Mesh::_IsSpaceFillingCurveOrderingOn = false;
+DofOrderingType Mesh::_dofOrdering = NO_DOF_ORDERING;
+std::string Mesh::_coarseMeshCheckpointFile = "";
+const unsigned Mesh::_checkpointVersion = 2;
 
 unsigned Mesh::_dimension=2;
 unsigned Mesh::_ref_index=4;  // 8*DIM[2]+4*DIM[1]+2*DIM[0];
@@ -103,34 +113,47 @@ void Mesh::ReadCoarseMesh(const std::string& name, const double Lref, std::vecto
 
   _level = 0;
 
-  if(name.rfind(".neu") < name.size())
-  {
-    GambitIO(*this).read(name,_coords,Lref,type_elem_flag);
-  }
-  else if(name.rfind(".med") < name.size()) {
-    SalomeIO(*this).read(name,_coords,Lref,type_elem_flag);
-  }
-  else
-  {
-    std::cerr << " ERROR: Unrecognized file extension: " << name
-	      << "\n   I understand the following:\n\n"
-	      << "     *.neu -- Gambit Neutral File\n"
-              << std::endl;
+  if(name.rfind(".fbm") < name.size()) {
+    // the partitioned mesh is loaded as it is, no parsing, partitioning and face search
+    ReadCoarseMeshCheckpoint(name, type_elem_flag);
+    BuildAdjVtx();
   }
+  else {
+    if(name.rfind(".neu") < name.size())
+    {
+      GambitIO(*this).read(name,_coords,Lref,type_elem_flag);
+    }
+    else if(name.rfind(".med") < name.size()) {
+      SalomeIO(*this).read(name,_coords,Lref,type_elem_flag);
+    }
+    else
+    {
+      std::cerr << " ERROR: Unrecognized file extension: " << name
+	        << "\n   I understand the following:\n\n"
+	        << "     *.neu -- Gambit Neutral File\n"
+	        << "     *.med -- Salome File\n"
+	        << "     *.fbm -- Femus Binary Mesh checkpoint\n"
+                << std::endl;
+    }
 
-  el->SetNodeNumber(_nnodes);
+    el->SetNodeNumber(_nnodes);
 
-  std::vector < int > partition;
-  partition.reserve(GetNumberOfNodes());
-  partition.resize(GetNumberOfElements());
-  MeshMetisPartitioning meshMetisPartitioning(*this);
-  meshMetisPartitioning.DoPartition(partition, false);
-  FillISvector(partition);
-  partition.resize(0);
+    std::vector < int > partition;
+    partition.reserve(GetNumberOfNodes());
+    partition.resize(GetNumberOfElements());
+    MeshMetisPartitioning meshMetisPartitioning(*this);
+    meshMetisPartitioning.DoPartition(partition, false);
+    FillISvector(partition);
+    partition.resize(0);
 
 
-  BuildAdjVtx();
-  Buildkel();
+    BuildAdjVtx();
+    Buildkel();
+
+    if( _coarseMeshCheckpointFile.size() > 0 ){
+      WriteCoarseMeshCheckpoint(_coarseMeshCheckpointFile, type_elem_flag);
+    }
+  }
 
   _topology = new Solution(this);
 
@@ -268,42 +291,97 @@ void Mesh::BuildAdjVtx() {
   }
 }
 
+/**
+ * This function returns the corner vertices of the face (iel,iface) in increasing order
+ **/
+static unsigned GetSortedFaceVertices(const elem *el, const unsigned &iel, const unsigned &iface, unsigned vertices[4]) {
+  unsigned nv = el->GetNFACENODES(el->GetElementType(iel), iface, 0);
+  for (unsigned i = 0; i < nv; i++) {
+    vertices[i] = el->GetFaceVertexIndex(iel, iface, i);
+  }
+  std::sort(vertices, vertices + nv);
+  return nv;
+}
+
+/**
+ * This function matches the faces of all the elements in a single pass: the faces are bucketed
+ * by their smallest vertex and compared only within the bucket through their sorted vertex tuples.
+ * For each face iel * NFC[0][1] + iface, faceNeighbour stores jel * NFC[0][1] + jface of the
+ * matching face of the adjacent element, or -1. Type 0 uses only the quadrilateral faces
+ **/
+void Mesh::BuildFaceNeighbours(std::vector < int > &faceNeighbour, const unsigned &type) {
+
+  const unsigned maxNumberOfFaces = NFC[0][1];
+  unsigned nel = el->GetElementNumber();
+  unsigned nvt = el->GetNodeNumber();
+
+  faceNeighbour.assign(nel * maxNumberOfFaces, -1);
+
+  unsigned iv[4], jv[4];
+
+  //BEGIN bucket the faces by their smallest vertex
+  std::vector < unsigned > bucketOffset(nvt + 1, 0);
+  for (unsigned iel = 0; iel < nel; iel++) {
+    for (unsigned iface = 0; iface < el->GetElementFaceNumber(iel, type); iface++) {
+      GetSortedFaceVertices(el, iel, iface, iv);
+      bucketOffset[iv[0]]++;
+    }
+  }
+  for (unsigned inode = 1; inode <= nvt; inode++) {
+    bucketOffset[inode] += bucketOffset[inode - 1];
+  }
+
+  std::vector < unsigned > bucket(bucketOffset[nvt]);
+  std::vector < unsigned > bucketCounter(bucketOffset.begin(), bucketOffset.end() - 1);
+  for (unsigned iel = 0; iel < nel; iel++) {
+    for (unsigned iface = 0; iface < el->GetElementFaceNumber(iel, type); iface++) {
+      GetSortedFaceVertices(el, iel, iface, iv);
+      bucket[ bucketCounter[iv[0] - 1u]++ ] = iel * maxNumberOfFaces + iface;
+    }
+  }
+  //END bucket the faces by their smallest vertex
+
+  //BEGIN match the faces with the same vertex tuple
+  for (unsigned inode = 0; inode < nvt; inode++) {
+    for (unsigned i = bucketOffset[inode]; i < bucketOffset[inode + 1]; i++) {
+      unsigned iface = bucket[i];
+      if (faceNeighbour[iface] != -1) continue;
+      unsigned niv = GetSortedFaceVertices(el, iface / maxNumberOfFaces, iface % maxNumberOfFaces, iv);
+      for (unsigned j = i + 1; j < bucketOffset[inode + 1]; j++) {
+        unsigned jface = bucket[j];
+        if (faceNeighbour[jface] != -1) continue;
+        unsigned njv = GetSortedFaceVertices(el, jface / maxNumberOfFaces, jface % maxNumberOfFaces, jv);
+        if (niv == njv && std::equal(iv, iv + niv, jv)) {
+          faceNeighbour[iface] = jface;
+          faceNeighbour[jface] = iface;
+          break;
+        }
+      }
+    }
+  }
+  //END match the faces with the same vertex tuple
+}
+
 /**
  * This function stores the element adiacent to the element face (iel,iface)
  * and stores it in kel[iel][iface]
  **/
 void Mesh::Buildkel() {
+
+  std::vector < int > faceNeighbour;
+  BuildFaceNeighbours(faceNeighbour, 1);
+
+  const unsigned maxNumberOfFaces = NFC[0][1];
+
   for (unsigned iel=0; iel<el->GetElementNumber(); iel++) {
     for (unsigned iface=0; iface<el->GetElementFaceNumber(iel); iface++) {
-      if ( el->GetFaceElementIndex(iel,iface) <= 0) {//TODO probably just == -1
-        unsigned i1=el->GetFaceVertexIndex(iel,iface,0);
-        unsigned i2=el->GetFaceVertexIndex(iel,iface,1);
-        unsigned i3=el->GetFaceVertexIndex(iel,iface,2);
-        for (unsigned j=0; j< el->GetVertexElementNumber(i1-1u); j++) {
-          unsigned jel= el->GetVertexElementIndex(i1-1u,j)-1u;
-          if (jel > iel) {
-            for (unsigned jface=0; jface<el->GetElementFaceNumber(jel); jface++) {
-              if ( el->GetFaceElementIndex(jel,jface) <= 0) {
-                unsigned j1=el->GetFaceVertexIndex(jel,jface,0);
-                unsigned j2=el->GetFaceVertexIndex(jel,jface,1);
-                unsigned j3=el->GetFaceVertexIndex(jel,jface,2);
-                unsigned j4=el->GetFaceVertexIndex(jel,jface,3);
-                if ((Mesh::_dimension==3 &&
-                     (i1==j1 || i1==j2 || i1==j3 ||  i1==j4 )&&
-                     (i2==j1 || i2==j2 || i2==j3 ||  i2==j4 )&&
-                     (i3==j1 || i3==j2 || i3==j3 ||  i3==j4 ))||
-                    (Mesh::_dimension==2 &&
-                     (i1==j1 || i1==j2 )&&
-                     (i2==j1 || i2==j2 ))||
-                    (Mesh::_dimension==1 &&
-                     (i1==j1))
-                   ) {
-                  el->SetFaceElementIndex(iel,iface,jel+1u);
-                  el->SetFaceElementIndex(jel,jface,iel+1u);
-                }
-              }
-            }
-          }
+      int jfaceGlobal = faceNeighbour[iel * maxNumberOfFaces + iface];
+      if ( jfaceGlobal >= 0 && el->GetFaceElementIndex(iel,iface) <= 0) {//TODO probably just == -1
+        unsigned jel = jfaceGlobal / maxNumberOfFaces;
+        unsigned jface = jfaceGlobal % maxNumberOfFaces;
+        if ( el->GetFaceElementIndex(jel,jface) <= 0) {
+          el->SetFaceElementIndex(iel,iface,jel+1u);
+          el->SetFaceElementIndex(jel,jface,iel+1u);
         }
       }
     }
@@ -312,27 +390,55 @@ void Mesh::Buildkel() {
 
 
 void Mesh::AllocateAndMarkStructureNode() {
-  el->AllocateNodeRegion();
-
-  vector <double> localizedElementMaterial;
-  _topology->_Sol[_materialIndex]->localize_to_all(localizedElementMaterial);
-  
-   vector <double> localizedElementType;
-  _topology->_Sol[_typeIndex]->localize_to_all(localizedElementType);
-
-  for (unsigned iel=0; iel<_nelem; iel++) {
-
-    //int flag_mat = el->GetElementMaterial(iel);
-    int flag_mat = static_cast < short unsigned > (localizedElementMaterial[iel]+ 0.25);
-
-    if (flag_mat==4) {
-      unsigned nve = el->GetNVE(localizedElementType[iel],2);
+  // the regions are stored for the owned nodes, the node halo of this process and the nodes of the children
+  // of the coarse elements owned by this process, that the prolongation reads and the AMR partitioning
+  // may have moved to other processes
+  std::vector < int > regionGhost = _ghostDofs[2][_iproc];
+  if (_coarseMsh) {
+    unsigned refIndex = GetRefIndex();
+    for (unsigned ielc = _coarseMsh->_elementOffset[_iproc]; ielc < _coarseMsh->_elementOffset[_iproc + 1]; ielc++) {
+      unsigned child0 = _coarseMsh->el->GetChildElement(ielc, 0);
+      unsigned nchildren = ( el->IsFatherRefined(child0) ) ? refIndex : 1;
+      for (unsigned j = 0; j < nchildren; j++) {
+        unsigned iel = _coarseMsh->el->GetChildElement(ielc, j);
+        if (iel >= _elementOffset[_iproc] && iel < _elementOffset[_iproc + 1]) continue;
+        for (unsigned i = 0; i < GetElementDofNumber(iel, 2); i++) {
+          unsigned inode = GetSolutionDof(i, iel, 2);
+          if (inode < _dofOffset[2][_iproc] || inode >= _dofOffset[2][_iproc] + _ownSize[2][_iproc]) regionGhost.push_back(inode);
+        }
+      }
+    }
+    std::sort(regionGhost.begin(), regionGhost.end());
+    regionGhost.erase(std::unique(regionGhost.begin(), regionGhost.end()), regionGhost.end());
+  }
+  el->AllocateNodeRegion(_dofOffset[2][_iproc], _ownSize[2][_iproc], regionGhost);
+
+  // flag the nodes of the owned solid elements; the ghost update brings on each process
+  // the flags of the stored nodes shared with solid elements owned by the other processes
+  NumericVector *nodeRegion = NumericVector::build().release();
+  if (_nprocs == 1) nodeRegion->init(_dofOffset[2][_nprocs], _ownSize[2][_iproc], false, SERIAL);
+  else nodeRegion->init(_dofOffset[2][_nprocs], _ownSize[2][_iproc], regionGhost, false, GHOSTED);
+  nodeRegion->zero();
+
+  for (unsigned iel = _elementOffset[_iproc]; iel < _elementOffset[_iproc + 1]; iel++) {
+    if (GetElementMaterial(iel) == 4) {
+      unsigned nve = GetElementDofNumber(iel, 2);
       for ( unsigned i=0; i<nve; i++) {
-        unsigned inode=el->GetElementVertexIndex(iel,i)-1u;
-        el->SetNodeRegion(inode, 1);
+        nodeRegion->set(GetSolutionDof(i, iel, 2), 1.);
       }
     }
   }
+  nodeRegion->close();
+
+  for (unsigned inode = _dofOffset[2][_iproc]; inode < _dofOffset[2][_iproc] + _ownSize[2][_iproc]; inode++) {
+    if ( (*nodeRegion)(inode) > 0.5 ) el->SetNodeRegion(inode, 1);
+  }
+  for (unsigned i = 0; i < regionGhost.size(); i++) {
+    unsigned inode = regionGhost[i];
+    if ( (*nodeRegion)(inode) > 0.5 ) el->SetNodeRegion(inode, 1);
+  }
+
+  delete nodeRegion;
 }
 
 
@@ -378,6 +484,10 @@ void Mesh::FillISvector(vector < int > &partition) {
     }
   }
 
+  // the finer levels inherit the ordering of the coarse mesh, since the children follow their father
+  if( _IsSpaceFillingCurveOrderingOn && GetLevel() == 0 ){
+    SpaceFillingCurveOrdering(mapping);
+  }
 
   if( GetLevel() == 0 ){
     el->ReorderMeshElements(mapping, NULL);
@@ -454,6 +564,10 @@ void Mesh::FillISvector(vector < int > &partition) {
     _dofOffset[2][i]= _dofOffset[2][i-1] + _ownSize[2][i-1];
   }
 
+  if( _dofOrdering != NO_DOF_ORDERING && GetLevel() == 0 ){
+    FillReducingNodeOrdering(mapping);
+  }
+
   el->ReorderMeshNodes( mapping );
 
   if( GetLevel() == 0 ){
@@ -552,6 +666,350 @@ void Mesh::FillISvector(vector < int > &partition) {
 }
 
 
+  // *******************************************************
+
+template < class T >
+static void WriteBinaryVector(std::ostream &out, const std::vector < T > &v) {
+  unsigned size = v.size();
+  out.write( (const char *) &size, sizeof(unsigned) );
+  if( size > 0 ) out.write( (const char *) &v[0], size * sizeof(T) );
+}
+
+template < class T >
+static void ReadBinaryVector(std::istream &in, std::vector < T > &v) {
+  unsigned size;
+  in.read( (char *) &size, sizeof(unsigned) );
+  v.resize(size);
+  if( size > 0 ) in.read( (char *) &v[0], size * sizeof(T) );
+}
+
+/**
+ * The checkpoint of process iproc out of nprocs is stored in the file name.nprocs.iproc
+ **/
+static std::string GetCheckpointFileName(const std::string &name, const int &nprocs, const int &iproc) {
+  std::ostringstream filename;
+  filename << name << "." << nprocs << "." << iproc;
+  return filename.str();
+}
+
+/**
+ * This function writes the partitioned coarse mesh, before the parallelized element quantities are deleted.
+ * Each process writes its own file, with the offsets, its ghost dofs and the global element arrays
+ **/
+void Mesh::WriteCoarseMeshCheckpoint(const std::string &name, const std::vector < bool > &type_elem_flag) {
+
+  std::string filename = GetCheckpointFileName(name, _nprocs, _iproc);
+  std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+  if( !out ){
+    cout << "Error: the mesh checkpoint file " << filename << " cannot be opened" << endl;
+    abort();
+  }
+
+  unsigned header[5] = {_checkpointVersion, static_cast < unsigned > (_nprocs), _dimension, static_cast < unsigned > (_nelem), _nnodes};
+  out.write( "FEMUSBM", 8 );
+  out.write( (const char *) header, 5 * sizeof(unsigned) );
+
+  std::vector < unsigned short > elementFlag( type_elem_flag.begin(), type_elem_flag.end() );
+  WriteBinaryVector(out, elementFlag);
+
+  for(unsigned i = 0; i < 3; i++){
+    WriteBinaryVector(out, _coords[i]);
+  }
+
+  WriteBinaryVector(out, _elementOffset);
+  for(unsigned k = 0; k < 5; k++){
+    WriteBinaryVector(out, _ownSize[k]);
+    WriteBinaryVector(out, _dofOffset[k]);
+    WriteBinaryVector(out, _ghostDofs[k][_iproc]);
+  }
+
+  for(unsigned k = 0; k < 2; k++){
+    WriteBinaryVector(out, _originalOwnSize[k]);
+    std::vector < unsigned > ownedGhost;
+    ownedGhost.reserve( 2 * _ownedGhostMap[k].size() );
+    for(std::map < unsigned, unsigned >::iterator it = _ownedGhostMap[k].begin(); it != _ownedGhostMap[k].end(); it++){
+      ownedGhost.push_back(it->first);
+      ownedGhost.push_back(it->second);
+    }
+    WriteBinaryVector(out, ownedGhost);
+  }
+
+  unsigned nBoundary = _boundaryinfo.size();
+  out.write( (const char *) &nBoundary, sizeof(unsigned) );
+  for(std::map < unsigned, std::string >::iterator it = _boundaryinfo.begin(); it != _boundaryinfo.end(); it++){
+    std::vector < char > boundaryName( it->second.begin(), it->second.end() );
+    out.write( (const char *) &it->first, sizeof(unsigned) );
+    WriteBinaryVector(out, boundaryName);
+  }
+
+  el->WriteCheckpoint(out);
+
+  out.close();
+}
+
+/**
+ * This function reads the partitioned coarse mesh written by WriteCoarseMeshCheckpoint with the same number of processes.
+ * Every array is read as a contiguous binary block
+ **/
+void Mesh::ReadCoarseMeshCheckpoint(const std::string &name, std::vector < bool > &type_elem_flag) {
+
+  std::string filename = GetCheckpointFileName(name, _nprocs, _iproc);
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if( !in ){
+    cout << "Error: the mesh checkpoint file " << filename << " cannot be opened,"
+         << " the checkpoint has to be written with the same number of processes" << endl;
+    abort();
+  }
+
+  char magic[8];
+  unsigned header[5];
+  in.read( magic, 8 );
+  in.read( (char *) header, 5 * sizeof(unsigned) );
+  if( strncmp(magic, "FEMUSBM", 8) != 0 || header[0] != _checkpointVersion || header[1] != static_cast < unsigned > (_nprocs) ){
+    cout << "Error: " << filename << " is not a version " << _checkpointVersion
+         << " mesh checkpoint for " << _nprocs << " processes" << endl;
+    abort();
+  }
+
+  SetDimension(header[2]);
+  SetNumberOfElements(header[3]);
+  SetNumberOfNodes(header[4]);
+
+  std::vector < unsigned short > elementFlag;
+  ReadBinaryVector(in, elementFlag);
+  type_elem_flag.assign(elementFlag.begin(), elementFlag.end());
+
+  for(unsigned i = 0; i < 3; i++){
+    ReadBinaryVector(in, _coords[i]);
+  }
+
+  ReadBinaryVector(in, _elementOffset);
+  for(unsigned k = 0; k < 5; k++){
+    ReadBinaryVector(in, _ownSize[k]);
+    ReadBinaryVector(in, _dofOffset[k]);
+    _ghostDofs[k].resize(_nprocs);
+    ReadBinaryVector(in, _ghostDofs[k][_iproc]);
+  }
+
+  for(unsigned k = 0; k < 2; k++){
+    ReadBinaryVector(in, _originalOwnSize[k]);
+    std::vector < unsigned > ownedGhost;
+    ReadBinaryVector(in, ownedGhost);
+    _ownedGhostMap[k].clear();
+    for(unsigned i = 0; i < ownedGhost.size(); i += 2){
+      _ownedGhostMap[k][ ownedGhost[i] ] = ownedGhost[i + 1];
+    }
+  }
+
+  unsigned nBoundary;
+  in.read( (char *) &nBoundary, sizeof(unsigned) );
+  for(unsigned i = 0; i < nBoundary; i++){
+    unsigned index;
+    std::vector < char > boundaryName;
+    in.read( (char *) &index, sizeof(unsigned) );
+    ReadBinaryVector(in, boundaryName);
+    _boundaryinfo[index] = std::string( boundaryName.begin(), boundaryName.end() );
+  }
+
+  el = new elem(_nelem);
+  el->ReadCheckpoint(in);
+
+  if( !in ){
+    cout << "Error: the mesh checkpoint file " << filename << " is truncated" << endl;
+    abort();
+  }
+  in.close();
+}
+
+  // *******************************************************
+
+/**
+ * This function sorts the elements of each partition along the Morton (Z-order) space filling curve
+ * of their centroids, so that the element loops and the nodes numbered from them are local in memory
+ **/
+void Mesh::SpaceFillingCurveOrdering(std::vector < unsigned > &mapping) {
+
+  const unsigned bits = 21;
+  const double maxCoordinate = static_cast < double > ( (1u << bits) - 1u );
+
+  double xmin[3] = {0., 0., 0.};
+  double xmax[3] = {0., 0., 0.};
+  for(unsigned k = 0; k < _dimension; k++){
+    xmin[k] = *std::min_element(_coords[k].begin(), _coords[k].end());
+    xmax[k] = *std::max_element(_coords[k].begin(), _coords[k].end());
+    if( xmax[k] <= xmin[k] ) xmax[k] = xmin[k] + 1.;
+  }
+
+  std::vector < std::pair < unsigned long long, unsigned > > key;
+
+  for(int isdom = 0; isdom < _nprocs; isdom++){
+    unsigned offset = _elementOffset[isdom];
+    key.resize(_elementOffset[isdom + 1] - offset);
+
+    for(unsigned i = 0; i < key.size(); i++){
+      unsigned iel = mapping[offset + i];
+      unsigned nve = el->GetElementDofNumber(iel, 0);
+
+      unsigned long long q[3] = {0, 0, 0};
+      for(unsigned k = 0; k < _dimension; k++){
+        double xc = 0.;
+        for(unsigned inode = 0; inode < nve; inode++){
+          xc += _coords[k][ el->GetElementVertexIndex(iel, inode) - 1u ];
+        }
+        xc /= nve;
+        q[k] = static_cast < unsigned long long > ( (xc - xmin[k]) / (xmax[k] - xmin[k]) * maxCoordinate + 0.5 );
+      }
+
+      // interleave the bits of the quantized coordinates
+      unsigned long long code = 0;
+      for(int b = bits - 1; b >= 0; b--){
+        for(unsigned k = 0; k < _dimension; k++){
+          code = (code << 1) | ( (q[k] >> b) & 1ull );
+        }
+      }
+      key[i] = std::make_pair(code, iel);
+    }
+
+    std::sort(key.begin(), key.end());
+
+    for(unsigned i = 0; i < key.size(); i++){
+      mapping[offset + i] = key[i].second;
+    }
+  }
+}
+
+  // *******************************************************
+
+/**
+ * Reverse Cuthill-McKee ordering of a graph: perm[newIndex] = oldIndex
+ **/
+static void ReverseCuthillMcKee(const std::vector < std::vector < unsigned > > &graph, std::vector < unsigned > &perm) {
+
+  unsigned n = graph.size();
+
+  std::vector < std::pair < unsigned, unsigned > > degree(n);
+  for(unsigned i = 0; i < n; i++){
+    degree[i] = std::make_pair(graph[i].size(), i);
+  }
+  std::sort(degree.begin(), degree.end());
+
+  std::vector < bool > visited(n, false);
+  std::vector < std::pair < unsigned, unsigned > > neighbours;
+  perm.resize(0);
+  perm.reserve(n);
+
+  // each connected component starts from its node of minimum degree
+  for(unsigned is = 0; is < n; is++){
+    unsigned start = degree[is].second;
+    if( visited[start] ) continue;
+    visited[start] = true;
+    unsigned head = perm.size();
+    perm.push_back(start);
+    while( head < perm.size() ){
+      unsigned i = perm[head];
+      head++;
+      neighbours.resize(0);
+      for(unsigned j = 0; j < graph[i].size(); j++){
+        unsigned jnode = graph[i][j];
+        if( !visited[jnode] ){
+          visited[jnode] = true;
+          neighbours.push_back( std::make_pair(graph[jnode].size(), jnode) );
+        }
+      }
+      std::sort(neighbours.begin(), neighbours.end());
+      for(unsigned j = 0; j < neighbours.size(); j++){
+        perm.push_back(neighbours[j].second);
+      }
+    }
+  }
+
+  std::reverse(perm.begin(), perm.end());
+}
+
+/**
+ * This function renumbers the owned nodes of each partition. The vertices, the mid-edge and the face/center nodes
+ * of each process are reordered separately, so that the dof offsets of all the Lagrangian fem types are kept
+ **/
+void Mesh::FillReducingNodeOrdering(std::vector < unsigned > &mapping) {
+
+  std::vector < unsigned > inverseMapping(mapping.size());
+  for(unsigned i = 0; i < mapping.size(); i++){
+    inverseMapping[ mapping[i] ] = i;
+  }
+
+  std::vector < std::vector < unsigned > > graph;
+  std::vector < unsigned > perm;
+
+  for(int isdom = 0; isdom < _nprocs; isdom++){
+    for(unsigned k = 0; k < 3; k++){
+      unsigned rangeStart = _dofOffset[2][isdom] + ( (k == 0) ? 0 : _ownSize[k-1][isdom] );
+      unsigned rangeEnd = _dofOffset[2][isdom] + _ownSize[k][isdom];
+      unsigned n = rangeEnd - rangeStart;
+      if( n < 2 ) continue;
+
+      // nodal graph restricted to the range, through the elements of this process
+      graph.assign(n, std::vector < unsigned > (0) );
+      for(unsigned iel = _elementOffset[isdom]; iel < _elementOffset[isdom+1]; iel++){
+        unsigned nve = el->GetElementDofNumber(iel,2);
+        for(unsigned i = 0; i < nve; i++){
+          unsigned ii = mapping[ el->GetElementVertexIndex(iel,i) - 1u ];
+          if( ii < rangeStart || ii >= rangeEnd ) continue;
+          for(unsigned j = 0; j < nve; j++){
+            unsigned jj = mapping[ el->GetElementVertexIndex(iel,j) - 1u ];
+            if( j != i && jj >= rangeStart && jj < rangeEnd ){
+              graph[ii - rangeStart].push_back(jj - rangeStart);
+            }
+          }
+        }
+      }
+      for(unsigned i = 0; i < n; i++){
+        std::sort(graph[i].begin(), graph[i].end());
+        graph[i].erase( std::unique(graph[i].begin(), graph[i].end()), graph[i].end() );
+      }
+
+      bool reordered = false;
+      if( _dofOrdering == NESTED_DISSECTION_DOF_ORDERING ){
+#ifdef HAVE_METIS
+        std::vector < idx_t > xadj(n + 1);
+        xadj[0] = 0;
+        for(unsigned i = 0; i < n; i++){
+          xadj[i+1] = xadj[i] + graph[i].size();
+        }
+        std::vector < idx_t > adjncy( (xadj[n] > 0) ? xadj[n] : 1 );
+        for(unsigned i = 0; i < n; i++){
+          for(unsigned j = 0; j < graph[i].size(); j++){
+            adjncy[xadj[i] + j] = graph[i][j];
+          }
+        }
+        idx_t nvtxs = n;
+        std::vector < idx_t > metisPerm(n);
+        std::vector < idx_t > metisIperm(n);
+        int err = METIS_NodeND(&nvtxs, &xadj[0], &adjncy[0], NULL, NULL, &metisPerm[0], &metisIperm[0]);
+        if( err == METIS_OK ){
+          perm.resize(n);
+          for(unsigned i = 0; i < n; i++){
+            perm[i] = metisPerm[i];
+          }
+          reordered = true;
+        }
+        else {
+          cout << "Warning: METIS_NodeND failed, using the RCM dof ordering" << endl;
+        }
+#else
+        cout << "Warning: nested dissection requires Metis, using the RCM dof ordering" << endl;
+#endif
+      }
+      if( !reordered ){
+        ReverseCuthillMcKee(graph, perm);
+      }
+
+      for(unsigned i = 0; i < n; i++){
+        mapping[ inverseMapping[ rangeStart + perm[i] ] ] = rangeStart + i;
+      }
+    }
+  }
+}
+
   // *******************************************************
   unsigned Mesh::IsdomBisectionSearch(const unsigned &dof, const short unsigned &solType) const{
 
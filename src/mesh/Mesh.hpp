@@ -23,6 +23,7 @@
 #include "Solution.hpp"
 #include "ElemType.hpp"
 #include "ElemTypeEnum.hpp"
+#include "DofOrderingEnum.hpp"
 #include "ParallelObject.hpp"
 #include <assert.h>
 
@@ -164,7 +165,8 @@ public:
       return Mesh::_face_index;
     }
 
-    /** Allocate memory for adding fluid or solid mark */
+    /** Allocate and mark the fluid or solid region of the owned and ghost nodes, using the owned
+        elements and the halo exchange of the node ghosts. No process stores the regions of the whole mesh */
     void AllocateAndMarkStructureNode();
 
 
@@ -192,6 +194,9 @@ public:
     /** To be added */
     void Buildkel();
 
+    /** Match the faces of the elements through their sorted vertex tuples (type 0 quadrilateral faces, type 1 all faces) */
+    void BuildFaceNeighbours(std::vector < int > &faceNeighbour, const unsigned &type);
+
     /** To be added */
     void BuildAdjVtx();
 
@@ -209,6 +214,22 @@ public:
     static bool (* _SetRefinementFlag)(const std::vector < double >& x,
                                        const int &ElemGroupNumber,const int &level);
     static bool _IsUserRefinementFunctionDefined;
+
+    /** Order the coarse mesh elements (and thus the nodes) of each partition along a space filling curve */
+    static void SetSpaceFillingCurveOrdering(const bool &value) {
+      _IsSpaceFillingCurveOrderingOn = value;
+    }
+
+    /** Write the partitioned coarse mesh read by ReadCoarseMesh in the binary checkpoint name (*.fbm), one file for each process.
+        Reading name afterwards with the same number of processes skips the parsing, the partitioning and the face search */
+    static void SetCoarseMeshCheckpoint(const std::string &name) {
+      _coarseMeshCheckpointFile = name;
+    }
+
+    /** Set the fill-reducing renumbering of the coarse mesh dofs (RCM or Metis nested dissection) */
+    static void SetDofOrdering(const DofOrderingType &type) {
+      _dofOrdering = type;
+    }
     std::map<unsigned int, std::string> _boundaryinfo;
 
     /** Get the projection matrix between Lagrange FEM at the same level mesh*/
@@ -248,6 +269,23 @@ private:
     /** Build the coarse to the fine projection matrix */
     void BuildCoarseToFineProjection(const unsigned& solType);
 
+    /** Sort the elements of each partition in mapping along the Morton space filling curve */
+    void SpaceFillingCurveOrdering(std::vector < unsigned > &mapping);
+
+    static bool _IsSpaceFillingCurveOrderingOn;
+
+    /** Renumber the owned nodes of each partition and dof type in mapping to reduce the bandwidth or the fill-in */
+    void FillReducingNodeOrdering(std::vector < unsigned > &mapping);
+
+    static DofOrderingType _dofOrdering;
+
+    /** Write/read the partitioned coarse mesh to/from the binary checkpoint of this process */
+    void WriteCoarseMeshCheckpoint(const std::string &name, const std::vector < bool > &type_elem_flag);
+    void ReadCoarseMeshCheckpoint(const std::string &name, std::vector < bool > &type_elem_flag);
+
+    static std::string _coarseMeshCheckpointFile;
+    static const unsigned _checkpointVersion;
+
     //member-data
     int _nelem;                                //< number of elements
     unsigned _nnodes;                          //< number of nodes
@@ -19,13 +19,31 @@
 #include "MeshMetisPartitioning.hpp"
 #include "Mesh.hpp"
 #include "FemusConfig.hpp"
+#include "GeomElTypeEnum.hpp"
 
 #ifdef HAVE_METIS
   #include "metis.h"
 #endif
 
+#ifdef HAVE_PETSC
+  #include "petscconf.h"
+#endif
+
+// ParMetis comes with the PETSc external packages, as Metis does
+#if defined(HAVE_METIS) && defined(HAVE_MPI) && defined(PETSC_HAVE_PARMETIS)
+  #define HAVE_PARMETIS
+  #include "parmetis.h"
+#endif
+
+#ifdef HAVE_MPI
+  #include <mpi.h>
+#endif
+
 //C++ include
 #include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
 
 
 namespace femus {
@@ -34,10 +52,127 @@ using std::cout;
 using std::endl;
 
 
+std::vector < double > MeshMetisPartitioning::_elementTypeWeight;
+double MeshMetisPartitioning::_solidElementWeight = 1.;
+bool MeshMetisPartitioning::_multiConstraint = false;
+std::vector < double > MeshMetisPartitioning::_measuredElementCost;
+const Mesh *MeshMetisPartitioning::_measuredCostMesh = NULL;
+double MeshMetisPartitioning::_rebalanceThreshold = 0.;
+
 MeshMetisPartitioning::MeshMetisPartitioning(Mesh& mesh) : MeshPartitioning(mesh) {
 
 }
 
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::SetElementWeights(const std::vector < double > &typeWeight, const double &solidWeight,
+                                              const bool &multiConstraint) {
+  _elementTypeWeight = typeWeight;
+  _elementTypeWeight.resize(N_GEOM_ELS, 1.);
+  _solidElementWeight = solidWeight;
+  _multiConstraint = multiConstraint;
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::SetMeasuredElementCost(const Mesh &mesh, const std::vector < double > &ownedElementCost) {
+
+  int nprocs, iproc;
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  MPI_Comm_rank(MPI_COMM_WORLD, &iproc);
+
+  unsigned ownSize = mesh._elementOffset[iproc + 1] - mesh._elementOffset[iproc];
+  int sizeError = ( ownedElementCost.size() != ownSize ), anySizeError;
+  MPI_Allreduce(&sizeError, &anySizeError, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  if( anySizeError ) {
+    if( iproc == 0 ) {
+      std::cout << "Warning MeshMetisPartitioning::SetMeasuredElementCost: the costs do not match the elements owned by the "
+                << "processes, the measured costs are not used" << std::endl;
+    }
+    ClearMeasuredElementCost();
+    return;
+  }
+
+  // every process has the costs of all the elements, for the serial Metis
+  std::vector < int > counts(nprocs);
+  std::vector < int > displs(nprocs);
+  for(int isdom = 0; isdom < nprocs; isdom++) {
+    counts[isdom] = mesh._elementOffset[isdom + 1] - mesh._elementOffset[isdom];
+    displs[isdom] = mesh._elementOffset[isdom];
+  }
+  _measuredElementCost.resize(mesh._elementOffset[nprocs] + 1u);
+  MPI_Allgatherv(const_cast < double* > ( ( ownSize > 0 ) ? &ownedElementCost[0] : NULL ), ownSize, MPI_DOUBLE,
+                 &_measuredElementCost[0], &counts[0], &displs[0], MPI_DOUBLE, MPI_COMM_WORLD);
+  _measuredElementCost.resize(mesh._elementOffset[nprocs]);
+  _measuredCostMesh = &mesh;
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::ClearMeasuredElementCost() {
+  // the measured costs belong to the mesh refined from the measured one only
+  _measuredElementCost.clear();
+  _measuredCostMesh = NULL;
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::MapMeasuredElementCost(const Mesh &meshc) {
+
+  _elementCost.resize(0);
+  if( _measuredCostMesh != &meshc ) return;
+
+  // the elements of the refined mesh are still numbered as built from the father elements
+  _elementCost.assign(_mesh.GetNumberOfElements(), 1.);
+  unsigned refIndex = _mesh.GetRefIndex();
+  for(unsigned iel = 0; iel < _measuredElementCost.size(); iel++) {
+    unsigned child0 = meshc.el->GetChildElement(iel, 0);
+    unsigned nchildren = ( _mesh.el->IsFatherRefined(child0) ) ? refIndex : 1;
+    for(unsigned j = 0; j < nchildren; j++) {
+      _elementCost[ meshc.el->GetChildElement(iel, j) ] = _measuredElementCost[iel];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned MeshMetisPartitioning::BuildElementWeights(std::vector < double > &weight, const unsigned &elementStart,
+                                                    const unsigned &elementEnd) {
+
+  unsigned nelem = _mesh.GetNumberOfElements();
+
+  bool typeWeights = ( _elementTypeWeight.size() != 0 );
+  bool measuredWeights = ( _elementCost.size() == nelem );
+  // the element material is stored in elem only while the coarse mesh is built
+  bool solidWeights = ( _mesh.GetLevel() == 0 && ( _solidElementWeight != 1. || _multiConstraint ) );
+
+  if( !typeWeights && !measuredWeights && !solidWeights ) {
+    weight.resize(0);
+    return 0;
+  }
+
+  // the solid work is balanced as a second constraint only if there are solid elements
+  unsigned ncon = 1;
+  if( solidWeights && _multiConstraint ) {
+    for(unsigned iel = 0; iel < nelem; iel++) {
+      if( _mesh.el->GetElementMaterial(iel) == 4 ) {
+        ncon = 2;
+        break;
+      }
+    }
+  }
+
+  weight.resize( (elementEnd - elementStart) * ncon );
+
+  for(unsigned iel = elementStart; iel < elementEnd; iel++) {
+    double cost = ( typeWeights ) ? _elementTypeWeight[ _mesh.el->GetElementType(iel) ] : 1.;
+    if( measuredWeights ) cost *= _elementCost[iel];
+
+    bool solid = ( solidWeights && _mesh.el->GetElementMaterial(iel) == 4 );
+
+    unsigned i = (iel - elementStart) * ncon;
+    weight[i] = ( solid ) ? cost * _solidElementWeight : cost;
+    if( ncon == 2 ) weight[i + 1] = ( solid ) ? weight[i] : 0.;
+  }
+
+  return ncon;
+}
+
 
 //------------------------------------------------------------------------------------------------------
 void MeshMetisPartitioning::DoPartition(std::vector <int> &epart, const bool &AMR) {
@@ -65,70 +200,375 @@ void MeshMetisPartitioning::DoPartition(std::vector <int> &epart, const bool &AM
     }
   }
   else {
+    clock_t start_time = clock();
+
+    // the distributed partitioning is used only when each process has enough elements
+    bool parallelPartitioning = false;
+#ifdef HAVE_PARMETIS
+    parallelPartitioning = ( static_cast < unsigned > (nelem) >= static_cast < unsigned > (_nprocs) * _parMetisMinElementsPerProcess );
+#endif
+
+    int edgeCut = ( parallelPartitioning ) ? DoParMetisPartition(epart, AMR) : DoMetisPartition(epart, AMR);
+
+    PrintPartitionStatistics(epart, edgeCut, clock() - start_time);
+  }
+  return;
+}
+
+/**
+ * This function converts the element weights to the integer weights of Metis, keeping positive the first constraint
+ **/
+static void ConvertElementWeights(const std::vector < double > &weight, const unsigned &ncon, vector < idx_t > &vwgt) {
+  vwgt.resize( weight.size() );
+  for(unsigned i = 0; i < weight.size(); i++) {
+    idx_t value = static_cast < idx_t > ( weight[i] * 100. + 0.5 );
+    if( i % ncon == 0 && value < 1 ) value = 1;
+    vwgt[i] = value;
+  }
+}
+
+//------------------------------------------------------------------------------------------------------
+int MeshMetisPartitioning::DoMetisPartition(std::vector <int> &epart, const bool &AMR) {
+
+  int nnodes = _mesh.GetNumberOfNodes();
+  int nelem = _mesh.GetNumberOfElements();
 
 #ifndef HAVE_METIS
-    std::cerr << "Fatal error: Metis library was not found. Metis partioning algorithm cannot be called!" << std::endl;
-    exit(1);
+  std::cerr << "Fatal error: Metis library was not found. Metis partioning algorithm cannot be called!" << std::endl;
+  exit(1);
 #endif
 
-    unsigned eind_size = _mesh.el->GetElementNumber("Hex")*NVE[0][2]      + _mesh.el->GetElementNumber("Tet")*NVE[1][2]
-                      + _mesh.el->GetElementNumber("Wedge")*NVE[2][2]    + _mesh.el->GetElementNumber("Quad")*NVE[3][2]
-                      + _mesh.el->GetElementNumber("Triangle")*NVE[4][2] + _mesh.el->GetElementNumber("Line")*NVE[5][2];
-
-    vector < idx_t > eptr(nelem+1);
-    vector < idx_t > eind(eind_size);
-
-    vector < int > npart(nnodes);
-
-    idx_t objval;
-    idx_t options[METIS_NOPTIONS];
-
-    METIS_SetDefaultOptions(options);
-
-    options[METIS_OPTION_NUMBERING]= 0;
-    options[METIS_OPTION_DBGLVL]   = 0;
-    options[METIS_OPTION_CTYPE]    = METIS_CTYPE_SHEM;
-    options[METIS_OPTION_PTYPE]    = METIS_PTYPE_KWAY;
-    options[METIS_OPTION_IPTYPE]   = METIS_IPTYPE_RANDOM;
-    options[METIS_OPTION_CONTIG]   = 0;
-    options[METIS_OPTION_MINCONN]  = 1;
-    options[METIS_OPTION_NITER]    = 10;
-    options[METIS_OPTION_UFACTOR]  = 100;
-
-    eptr[0]=0;
-    unsigned counter=0;
-    for (unsigned iel = 0; iel<nelem; iel++) {
-      unsigned ndofs = _mesh.el->GetElementDofNumber(iel,2);
-      eptr[iel+1] = eptr[iel] + ndofs;
-      for (unsigned inode = 0; inode < ndofs; inode++){
-        eind[counter] = _mesh.el->GetElementVertexIndex(iel,inode)-1;
-        counter++;
-      }
+  unsigned eind_size = _mesh.el->GetElementNumber("Hex")*NVE[0][2]      + _mesh.el->GetElementNumber("Tet")*NVE[1][2]
+                    + _mesh.el->GetElementNumber("Wedge")*NVE[2][2]    + _mesh.el->GetElementNumber("Quad")*NVE[3][2]
+                    + _mesh.el->GetElementNumber("Triangle")*NVE[4][2] + _mesh.el->GetElementNumber("Line")*NVE[5][2];
+
+  vector < idx_t > eptr(nelem+1);
+  vector < idx_t > eind(eind_size);
+
+  vector < int > npart(nnodes);
+
+  idx_t objval;
+  idx_t options[METIS_NOPTIONS];
+
+  METIS_SetDefaultOptions(options);
+
+  options[METIS_OPTION_NUMBERING]= 0;
+  options[METIS_OPTION_DBGLVL]   = 0;
+  options[METIS_OPTION_CTYPE]    = METIS_CTYPE_SHEM;
+  options[METIS_OPTION_PTYPE]    = METIS_PTYPE_KWAY;
+  options[METIS_OPTION_IPTYPE]   = METIS_IPTYPE_RANDOM;
+  options[METIS_OPTION_CONTIG]   = 0;
+  options[METIS_OPTION_MINCONN]  = 1;
+  options[METIS_OPTION_NITER]    = 10;
+  options[METIS_OPTION_UFACTOR]  = 100;
+
+  eptr[0]=0;
+  unsigned counter=0;
+  for (unsigned iel = 0; iel<nelem; iel++) {
+    unsigned ndofs = _mesh.el->GetElementDofNumber(iel,2);
+    eptr[iel+1] = eptr[iel] + ndofs;
+    for (unsigned inode = 0; inode < ndofs; inode++){
+      eind[counter] = _mesh.el->GetElementVertexIndex(iel,inode)-1;
+      counter++;
     }
+  }
+
 
+  int ncommon = ( AMR || _mesh.GetDimension() == 1 ) ? 1 : _mesh.GetDimension()+1;
 
-    int ncommon = ( AMR || _mesh.GetDimension() == 1 ) ? 1 : _mesh.GetDimension()+1;
+  std::vector < double > weight;
+  int ncon = BuildElementWeights(weight, 0, nelem);
+  vector < idx_t > vwgt;
+  ConvertElementWeights(weight, ncon, vwgt);
 
+  int err;
+  if( ncon < 2 ) {
     //I call the Mesh partioning function of Metis library (output is epart(own elem) and npart (own nodes))
-    int err = METIS_PartMeshDual(&nelem, &nnodes, &eptr[0], &eind[0], NULL, NULL, &ncommon, &_nprocs, NULL, options, &objval, &epart[0], &npart[0]);
+    err = METIS_PartMeshDual(&nelem, &nnodes, &eptr[0], &eind[0], (ncon == 1) ? &vwgt[0] : NULL, NULL, &ncommon, &_nprocs, NULL, options, &objval, &epart[0], &npart[0]);
+  }
+  else {
+    // multi-constraint partitioning is available only for graphs: build the dual graph first
+    int numflag = 0;
+    idx_t *xadj;
+    idx_t *adjncy;
+    err = METIS_MeshToDual(&nelem, &nnodes, &eptr[0], &eind[0], &ncommon, &numflag, &xadj, &adjncy);
 
     if(err == METIS_OK) {
-      std::cout << " METIS PARTITIONING IS OK " << std::endl;
+      idx_t graphOptions[METIS_NOPTIONS];
+      METIS_SetDefaultOptions(graphOptions);
+      graphOptions[METIS_OPTION_NUMBERING] = 0;
+      graphOptions[METIS_OPTION_NITER]     = 10;
+      graphOptions[METIS_OPTION_UFACTOR]   = 100;
+
+      err = METIS_PartGraphKway(&nelem, &ncon, xadj, adjncy, &vwgt[0], NULL, NULL, &_nprocs, NULL, NULL, graphOptions, &objval, &epart[0]);
+
+      METIS_Free(xadj);
+      METIS_Free(adjncy);
     }
-    else if(err == METIS_ERROR_INPUT) {
-      cout << " METIS_ERROR_INPUT " << endl;
-      exit(1);
+  }
+
+  if(err == METIS_OK) {
+    std::cout << " METIS PARTITIONING IS OK " << std::endl;
+  }
+  else if(err == METIS_ERROR_INPUT) {
+    cout << " METIS_ERROR_INPUT " << endl;
+    exit(1);
+  }
+  else if (err == METIS_ERROR_MEMORY) {
+    cout << " METIS_ERROR_MEMORY " << endl;
+    exit(2);
+  }
+  else {
+    cout << " METIS_GENERIC_ERROR " << endl;
+    exit(3);
+  }
+
+  return objval;
+}
+
+#ifdef HAVE_PARMETIS
+/**
+ * This function gives to each process a contiguous slice of the element list and builds
+ * its element->node lists, as required by the ParMetis distributed mesh functions
+ **/
+static void BuildDistributedElementNodes(Mesh &mesh, const int &nprocs, const int &iproc,
+                                         vector < idx_t > &elmdist, vector < idx_t > &eptr, vector < idx_t > &eind) {
+
+  long nelem = mesh.GetNumberOfElements();
+
+  elmdist.resize(nprocs + 1);
+  for (int isdom = 0; isdom <= nprocs; isdom++) {
+    elmdist[isdom] = static_cast < idx_t > ( (nelem * isdom) / nprocs );
+  }
+
+  unsigned elementStart = elmdist[iproc];
+  unsigned nlocal = elmdist[iproc + 1] - elmdist[iproc];
+
+  eptr.resize(nlocal + 1);
+  eind.resize(0);
+  eind.reserve(nlocal * NVE[0][2]);
+
+  eptr[0] = 0;
+  for (unsigned iel = 0; iel < nlocal; iel++) {
+    unsigned ndofs = mesh.el->GetElementDofNumber(elementStart + iel, 2);
+    eptr[iel + 1] = eptr[iel] + ndofs;
+    for (unsigned inode = 0; inode < ndofs; inode++) {
+      eind.push_back( mesh.el->GetElementVertexIndex(elementStart + iel, inode) - 1 );
     }
-    else if (err == METIS_ERROR_MEMORY) {
-      cout << " METIS_ERROR_MEMORY " << endl;
-      exit(2);
+  }
+}
+
+/**
+ * This function gathers on all the processes the element partition computed on the local slices
+ **/
+static void GatherDistributedPartition(const vector < idx_t > &elmdist, const vector < idx_t > &part,
+                                       const int &nprocs, const int &iproc, std::vector < int > &epart) {
+
+  vector < int > localPart(part.begin(), part.end());
+  vector < int > recvCounts(nprocs);
+  vector < int > displs(nprocs);
+
+  for (int isdom = 0; isdom < nprocs; isdom++) {
+    displs[isdom] = elmdist[isdom];
+    recvCounts[isdom] = elmdist[isdom + 1] - elmdist[isdom];
+  }
+
+  MPI_Allgatherv(&localPart[0], recvCounts[iproc], MPI_INT, &epart[0], &recvCounts[0], &displs[0], MPI_INT, MPI_COMM_WORLD);
+}
+
+#endif
+
+//------------------------------------------------------------------------------------------------------
+int MeshMetisPartitioning::DoParMetisPartition(std::vector <int> &epart, const bool &AMR) {
+
+#ifndef HAVE_PARMETIS
+  std::cerr << "Fatal error: ParMetis library was not found. ParMetis partioning algorithm cannot be called!" << std::endl;
+  exit(1);
+#else
+
+  vector < idx_t > elmdist;
+  vector < idx_t > eptr;
+  vector < idx_t > eind;
+  BuildDistributedElementNodes(_mesh, _nprocs, _iproc, elmdist, eptr, eind);
+
+  std::vector < double > weight;
+  idx_t ncon = BuildElementWeights(weight, elmdist[_iproc], elmdist[_iproc + 1]);
+  vector < idx_t > vwgt;
+  ConvertElementWeights(weight, ncon, vwgt);
+
+  idx_t wgtflag = ( ncon > 0 ) ? 2 : 0;
+  if( ncon == 0 ) ncon = 1;
+  idx_t numflag = 0;
+  idx_t ncommon = ( AMR || _mesh.GetDimension() == 1 ) ? 1 : _mesh.GetDimension() + 1;
+  idx_t nparts = _nprocs;
+  vector < real_t > tpwgts(ncon * nparts, 1. / nparts);
+  vector < real_t > ubvec(ncon, 1.05);
+  idx_t options[3] = {0, 0, 0};
+  idx_t edgecut;
+  vector < idx_t > part(eptr.size() - 1);
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int err = ParMETIS_V3_PartMeshKway(&elmdist[0], &eptr[0], &eind[0], (wgtflag == 2) ? &vwgt[0] : NULL, &wgtflag, &numflag, &ncon, &ncommon, &nparts,
+                                     &tpwgts[0], &ubvec[0], options, &edgecut, &part[0], &comm);
+
+  if(err != METIS_OK) {
+    cout << " PARMETIS_ERROR in ParMETIS_V3_PartMeshKway " << endl;
+    exit(1);
+  }
+
+  GatherDistributedPartition(elmdist, part, _nprocs, _iproc, epart);
+
+  return edgecut;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::RefinePartition(std::vector <int> &epart, const bool &AMR) {
+
+  if( _nprocs == 1 ) return;
+
+  clock_t start_time = clock();
+  int edgeCut = -1;
+
+#ifdef HAVE_PARMETIS
+  vector < idx_t > elmdist;
+  vector < idx_t > eptr;
+  vector < idx_t > eind;
+  BuildDistributedElementNodes(_mesh, _nprocs, _iproc, elmdist, eptr, eind);
+
+  idx_t numflag = 0;
+  idx_t ncommon = ( AMR || _mesh.GetDimension() == 1 ) ? 1 : _mesh.GetDimension() + 1;
+  idx_t *xadj;
+  idx_t *adjncy;
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int err = ParMETIS_V3_Mesh2Dual(&elmdist[0], &eptr[0], &eind[0], &numflag, &ncommon, &xadj, &adjncy, &comm);
+
+  if(err != METIS_OK) {
+    cout << " PARMETIS_ERROR in ParMETIS_V3_Mesh2Dual " << endl;
+    exit(1);
+  }
+
+  std::vector < double > weight;
+  idx_t ncon = BuildElementWeights(weight, elmdist[_iproc], elmdist[_iproc + 1]);
+  vector < idx_t > vwgt;
+  ConvertElementWeights(weight, ncon, vwgt);
+
+  idx_t wgtflag = ( ncon > 0 ) ? 2 : 0;
+  if( ncon == 0 ) ncon = 1;
+  idx_t nparts = _nprocs;
+  vector < real_t > tpwgts(ncon * nparts, 1. / nparts);
+  vector < real_t > ubvec(ncon, 1.05);
+  idx_t options[3] = {0, 0, 0};
+  idx_t edgecut;
+
+  // the current partition is the starting point of the refinement
+  vector < idx_t > part(epart.begin() + elmdist[_iproc], epart.begin() + elmdist[_iproc + 1]);
+
+  err = ParMETIS_V3_RefineKway(&elmdist[0], xadj, adjncy, (wgtflag == 2) ? &vwgt[0] : NULL, NULL, &wgtflag, &numflag, &ncon, &nparts,
+                               &tpwgts[0], &ubvec[0], options, &edgecut, &part[0], &comm);
+
+  free(xadj);
+  free(adjncy);
+
+  if(err != METIS_OK) {
+    cout << " PARMETIS_ERROR in ParMETIS_V3_RefineKway " << endl;
+    exit(1);
+  }
+
+  GatherDistributedPartition(elmdist, part, _nprocs, _iproc, epart);
+  edgeCut = edgecut;
+#endif
+
+  PrintPartitionStatistics(epart, edgeCut, clock() - start_time);
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::DoAMRPartition(std::vector <int> &epart, const Mesh& meshc) {
+
+  epart.resize( _mesh.GetNumberOfElements() );
+
+  // the children of each coarse element go to the process of their father
+  unsigned refIndex = _mesh.GetRefIndex();
+  for(int isdom = 0; isdom < _nprocs; isdom++) {
+    for(unsigned iel = meshc._elementOffset[isdom]; iel < meshc._elementOffset[isdom + 1]; iel++) {
+      unsigned child0 = meshc.el->GetChildElement(iel, 0);
+      unsigned nchildren = ( _mesh.el->IsFatherRefined(child0) ) ? refIndex : 1;
+      for(unsigned j = 0; j < nchildren; j++) {
+        epart[ meshc.el->GetChildElement(iel, j) ] = isdom;
+      }
+    }
+  }
+
+  MapMeasuredElementCost(meshc);
+  if( _measuredCostMesh == &meshc ) ClearMeasuredElementCost();
+
+  if( _nprocs == 1 ) return;
+
+  double imbalance = GetImbalance(epart);
+
+  if( imbalance > _rebalanceThreshold ) {
+    if( _iproc == 0 ) {
+      std::cout << " AMR PARTITION IMBALANCE = " << imbalance << ", REBALANCING " << std::endl;
     }
-    else {
-      cout << " METIS_GENERIC_ERROR " << endl;
-      exit(3);
+    // as in DoPartition, ParMetis is used only when each process has enough elements
+    bool parallelPartitioning = false;
+#ifdef HAVE_PARMETIS
+    parallelPartitioning = ( epart.size() >= static_cast < unsigned > (_nprocs) * _parMetisMinElementsPerProcess );
+#endif
+    if( parallelPartitioning ) RefinePartition(epart, true);
+    else DoPartition(epart, true);
+  }
+}
+
+//------------------------------------------------------------------------------------------------------
+double MeshMetisPartitioning::GetImbalance(const std::vector <int> &epart) {
+
+  std::vector < double > weight;
+  unsigned ncon = BuildElementWeights(weight, 0, epart.size());
+
+  vector < double > partWeight(_nprocs, 0.);
+  double totalWeight = 0.;
+  for(unsigned iel = 0; iel < epart.size(); iel++) {
+    double elementWeight = ( ncon > 0 ) ? weight[iel * ncon] : 1.;
+    partWeight[ epart[iel] ] += elementWeight;
+    totalWeight += elementWeight;
+  }
+
+  return *std::max_element(partWeight.begin(), partWeight.end()) * _nprocs / totalWeight;
+}
+
+//------------------------------------------------------------------------------------------------------
+void MeshMetisPartitioning::PrintPartitionStatistics(const std::vector <int> &epart, const int &edgeCut, const clock_t &partitionTime) {
+
+  if( _iproc == 0 ) {
+    vector < unsigned > partSize(_nprocs, 0);
+    for(unsigned iel = 0; iel < epart.size(); iel++) {
+      partSize[ epart[iel] ]++;
     }
+
+    unsigned maxPartSize = *std::max_element(partSize.begin(), partSize.end());
+    double imbalance = static_cast < double > (maxPartSize) * _nprocs / epart.size();
+
+    std::cout << " PARTITIONING TIME = " << static_cast < double > (partitionTime) / CLOCKS_PER_SEC << " s";
+    if( edgeCut >= 0 ) std::cout << ", EDGE-CUT = " << edgeCut;
+    std::cout << ", IMBALANCE = " << imbalance;
+
+    // imbalance of each weight constraint
+    std::vector < double > weight;
+    unsigned ncon = BuildElementWeights(weight, 0, epart.size());
+    for(unsigned icon = 0; icon < ncon; icon++) {
+      vector < double > partWeight(_nprocs, 0.);
+      double totalWeight = 0.;
+      for(unsigned iel = 0; iel < epart.size(); iel++) {
+        partWeight[ epart[iel] ] += weight[iel * ncon + icon];
+        totalWeight += weight[iel * ncon + icon];
+      }
+      double maxPartWeight = *std::max_element(partWeight.begin(), partWeight.end());
+      std::cout << ", WEIGHT " << icon << " IMBALANCE = " << maxPartWeight * _nprocs / totalWeight;
+    }
+    std::cout << std::endl;
   }
-  return;
 }
 
 void MeshMetisPartitioning::DoPartition(std::vector <int> &epart, const Mesh& meshc){
@@ -141,6 +581,8 @@ void MeshMetisPartitioning::DoPartition(std::vector <int> &epart, const Mesh& me
       }
     }
   }
+  // the partition is inherited, the measured costs of meshc are not needed
+  if( _measuredCostMesh == &meshc ) ClearMeasuredElementCost();
 }
 
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
 // includes :
 //----------------------------------------------------------------------------
 #include <vector>
+#include <ctime>
 #include "MeshPartitioning.hpp"
 
 namespace femus {
@@ -44,15 +45,73 @@ public:
     ~MeshMetisPartitioning() {};
 
     /** New Metis parallel partitioning:
-     *  for coarse and AMR mesh */
+     *  for coarse and AMR mesh. ParMetis is used, if available, when each process has
+     *  at least _parMetisMinElementsPerProcess elements, otherwise serial Metis */
     void DoPartition( std::vector < int > &epart, const bool &AMR );
 
+    /** Set the element weights of the partitioning: the cost of each element type (hex, tet, wedge, quad, triangle, line)
+     *  and the cost factor of the solid elements (material 4). With multiConstraint the solid work is also balanced
+     *  as a second constraint. The solid weights use the material stored in elem, thus only for the coarse mesh partitioning */
+    static void SetElementWeights( const std::vector < double > &typeWeight, const double &solidWeight = 1.,
+                                   const bool &multiConstraint = false );
+
+    /** Set a measured (relative) cost, e.g. the assembly time, for each element owned by this process in the partitioned
+     *  mesh, in the element numbering of the mesh: the children of the next mesh refined from it inherit the cost of their
+     *  father. Collective, the costs are discarded once the refined mesh has been partitioned */
+    static void SetMeasuredElementCost( const Mesh &mesh, const std::vector < double > &ownedElementCost );
+
+    /** Partitioning of an AMR mesh: each child element stays on the process of its father, and the partition
+     *  is rebalanced only if the element imbalance max/average exceeds the rebalance threshold, with the ParMetis
+     *  refinement when each process has at least _parMetisMinElementsPerProcess elements, otherwise serial Metis */
+    void DoAMRPartition( std::vector < int > &epart, const Mesh &meshc );
+
+    /** Set the imbalance max/average above which the AMR partitions are rebalanced (0 = always) */
+    static void SetRebalanceThreshold( const double &threshold ) {
+      _rebalanceThreshold = threshold;
+    };
+
+    /** Improve the partition epart with the ParMetis refinement, moving as few elements
+     *  as possible. Without ParMetis the partition is left unchanged */
+    void RefinePartition( std::vector < int > &epart, const bool &AMR );
+
     /** Parallel partitioning imported from coarser mesh partition:
      *  for uniformed refined meshes */
     void DoPartition( std::vector < int > &epart, const Mesh &meshc );
 
 private:
 
+    /** Serial Metis partitioning of the whole mesh, returns the edge-cut */
+    int DoMetisPartition( std::vector < int > &epart, const bool &AMR );
+
+    /** ParMetis partitioning of the dual graph, each process owns a slice of the elements, returns the edge-cut */
+    int DoParMetisPartition( std::vector < int > &epart, const bool &AMR );
+
+    /** Discard the measured costs after the partitioning of the mesh refined from the measured one */
+    static void ClearMeasuredElementCost();
+
+    /** The cost of each element of the mesh refined from meshc, inherited from the measured cost of its father */
+    void MapMeasuredElementCost( const Mesh &meshc );
+
+    /** Build the ncon element weights of the elements in [elementStart, elementEnd), returns ncon (0 = no weights) */
+    unsigned BuildElementWeights( std::vector < double > &weight, const unsigned &elementStart, const unsigned &elementEnd );
+
+    /** Weighted imbalance max/average of the partition epart (first weight constraint) */
+    double GetImbalance( const std::vector < int > &epart );
+
+    /** Print the partitioning time, the edge-cut (if >= 0) and the element imbalance max/average */
+    void PrintPartitionStatistics( const std::vector < int > &epart, const int &edgeCut, const clock_t &partitionTime );
+
+    static const unsigned _parMetisMinElementsPerProcess = 1000;
+
+    static std::vector < double > _elementTypeWeight;
+    static double _solidElementWeight;
+    static bool _multiConstraint;
+    static std::vector < double > _measuredElementCost;
+    static const Mesh *_measuredCostMesh;
+
+    /** the measured cost of each element of the mesh being partitioned */
+    std::vector < double > _elementCost;
+    static double _rebalanceThreshold;
 
 };
 
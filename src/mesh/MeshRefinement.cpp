@@ -248,74 +248,7 @@ namespace femus {
     _mesh.SetNumberOfNodes(nnodes);
     _mesh.el->SetNodeNumber(nnodes);
 
-    //find all the elements near each vertex
-    _mesh.BuildAdjVtx(); //TODO
-
-    //initialize to zero all the middle edge points
-    for (unsigned iel = 0; iel < _mesh.GetNumberOfElements(); iel++) {
-      if (_mesh.el->IsFatherRefined(iel)) {
-        for (unsigned inode = _mesh.el->GetElementDofNumber(iel, 0); inode < _mesh.el->GetElementDofNumber(iel, 1); inode++) {
-          _mesh.el->SetElementVertexIndex(iel, inode, 0);
-        }
-      }
-    }
-
-    //find all the middle edge points
-    for (unsigned iel = 0; iel < _mesh.GetNumberOfElements(); iel++) {
-      if (_mesh.el->IsFatherRefined(iel)) {
-        unsigned ielt = _mesh.el->GetElementType(iel);
-        unsigned istart = _mesh.el->GetElementDofNumber(iel, 0);
-        unsigned iend = _mesh.el->GetElementDofNumber(iel, 1);
-
-        for (unsigned inode = istart; inode < iend; inode++) {
-          if (0 == _mesh.el->GetElementVertexIndex(iel, inode)) {
-            nnodes++;
-            _mesh.el->SetElementVertexIndex(iel, inode, nnodes);
-            unsigned im = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][inode - istart][0]);
-            unsigned ip = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][inode - istart][1]);
-
-            //find all the near elements which share the same middle edge point
-            for (unsigned j = 0; j < _mesh.el->GetVertexElementNumber(im - 1u); j++) {
-              unsigned jel = _mesh.el->GetVertexElementIndex(im - 1u, j) - 1u;
-
-              if (_mesh.el->IsFatherRefined(jel) && jel > iel) {    // to skip coarse elements
-                unsigned jm = 0, jp = 0;
-                unsigned jelt = _mesh.el->GetElementType(jel);
-
-                for (unsigned jnode = 0; jnode < _mesh.el->GetElementDofNumber(jel, 0); jnode++) {
-                  if (_mesh.el->GetElementVertexIndex(jel, jnode) == im) {
-                    jm = jnode + 1u;
-                    break;
-                  }
-                }
-
-                if (jm != 0) { //TODO this can be changed and put inside (by Sara)
-                  for (unsigned jnode = 0; jnode < _mesh.el->GetElementDofNumber(jel, 0); jnode++) {
-                    if (_mesh.el->GetElementVertexIndex(jel, jnode) == ip) {
-                      jp = jnode + 1u;
-                      break;
-                    }
-                  }
-
-                  if (jp != 0) {
-                    if (jp < jm) {
-                      unsigned tp = jp;
-                      jp = jm;
-                      jm = tp;
-                    }
-
-                    _mesh.el->SetElementVertexIndex(jel, vertices2EdgeMapping[jelt][--jm][--jp], nnodes);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    }
-
-    _mesh.SetNumberOfNodes(nnodes);
-    _mesh.el->SetNodeNumber(nnodes);
+    Buildkedge();
 
     Buildkmid();
 
@@ -326,7 +259,7 @@ namespace femus {
     MeshMetisPartitioning meshMetisPartitioning(_mesh);
 
     if (AMR == true) {
-      meshMetisPartitioning.DoPartition(partition, AMR);
+      meshMetisPartitioning.DoAMRPartition(partition, *mshc);
     }
     else {
       meshMetisPartitioning.DoPartition(partition, *mshc);
@@ -385,6 +318,95 @@ namespace femus {
   }
 
 
+  /**
+   * This function generates the middle edge dofs of the refined elements. The edges are bucketed
+   * by their smallest vertex, and the edges with the same end vertices share the same new dof
+   **/
+  void MeshRefinement::Buildkedge() {
+
+    unsigned int nnodes = _mesh.GetNumberOfNodes();
+    unsigned nvt = nnodes;
+    unsigned nel = _mesh.el->GetElementNumber();
+
+    const unsigned maxNumberOfEdges = 12;
+
+    //intialize to zero
+    for (unsigned iel = 0; iel < nel; iel++) {
+      if (_mesh.el->IsFatherRefined(iel)) {
+        for (unsigned inode = _mesh.el->GetElementDofNumber(iel, 0); inode < _mesh.el->GetElementDofNumber(iel, 1); inode++) {
+          _mesh.el->SetElementVertexIndex(iel, inode, 0);
+        }
+      }
+    }
+
+    //BEGIN bucket the edges of the refined elements by their smallest vertex
+    std::vector < unsigned > bucketOffset(nvt + 1, 0);
+
+    for (unsigned iel = 0; iel < nel; iel++) {
+      if (_mesh.el->IsFatherRefined(iel)) {
+        unsigned ielt = _mesh.el->GetElementType(iel);
+        unsigned nedges = _mesh.el->GetElementDofNumber(iel, 1) - _mesh.el->GetElementDofNumber(iel, 0);
+
+        for (unsigned iedge = 0; iedge < nedges; iedge++) {
+          unsigned im = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][iedge][0]);
+          unsigned ip = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][iedge][1]);
+          bucketOffset[ (im < ip) ? im : ip ]++;
+        }
+      }
+    }
+
+    for (unsigned inode = 1; inode <= nvt; inode++) {
+      bucketOffset[inode] += bucketOffset[inode - 1];
+    }
+
+    std::vector < unsigned > bucket(bucketOffset[nvt]);
+    std::vector < unsigned > otherVertex(bucketOffset[nvt]);
+    std::vector < unsigned > bucketCounter(bucketOffset.begin(), bucketOffset.end() - 1);
+
+    for (unsigned iel = 0; iel < nel; iel++) {
+      if (_mesh.el->IsFatherRefined(iel)) {
+        unsigned ielt = _mesh.el->GetElementType(iel);
+        unsigned nedges = _mesh.el->GetElementDofNumber(iel, 1) - _mesh.el->GetElementDofNumber(iel, 0);
+
+        for (unsigned iedge = 0; iedge < nedges; iedge++) {
+          unsigned im = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][iedge][0]);
+          unsigned ip = _mesh.el->GetElementVertexIndex(iel, edge2VerticesMapping[ielt][iedge][1]);
+          unsigned position = bucketCounter[ ((im < ip) ? im : ip) - 1u ]++;
+          bucket[position] = iel * maxNumberOfEdges + iedge;
+          otherVertex[position] = (im < ip) ? ip : im;
+        }
+      }
+    }
+    //END bucket the edges of the refined elements by their smallest vertex
+
+    //BEGIN number the middle edge points
+    for (unsigned inode = 0; inode < nvt; inode++) {
+      for (unsigned i = bucketOffset[inode]; i < bucketOffset[inode + 1]; i++) {
+        unsigned iel = bucket[i] / maxNumberOfEdges;
+        unsigned iedgeNode = _mesh.el->GetElementDofNumber(iel, 0) + bucket[i] % maxNumberOfEdges;
+
+        if (0 == _mesh.el->GetElementVertexIndex(iel, iedgeNode)) {
+          nnodes++;
+          _mesh.el->SetElementVertexIndex(iel, iedgeNode, nnodes);
+
+          for (unsigned j = i + 1; j < bucketOffset[inode + 1]; j++) {
+            if (otherVertex[j] == otherVertex[i]) {
+              unsigned jel = bucket[j] / maxNumberOfEdges;
+              unsigned jedgeNode = _mesh.el->GetElementDofNumber(jel, 0) + bucket[j] % maxNumberOfEdges;
+              _mesh.el->SetElementVertexIndex(jel, jedgeNode, nnodes);
+            }
+          }
+        }
+      }
+    }
+    //END number the middle edge points
+
+    _mesh.SetNumberOfNodes(nnodes);
+    _mesh.el->SetNodeNumber(nnodes);
+
+  }
+
+
   /**
    * This function generates face (for hex and wedge elements) and element (for hex and quad) dofs
    **/
@@ -402,6 +424,11 @@ namespace femus {
     }
 
     // generate face dofs for hex and wedge elements
+    std::vector < int > faceNeighbour;
+    _mesh.BuildFaceNeighbours(faceNeighbour, 0);
+
+    const unsigned maxNumberOfFaces = NFC[0][1];
+
     for (unsigned iel = 0; iel < _mesh.el->GetElementNumber(); iel++) {
       if (_mesh.el->IsFatherRefined(iel)) {
         for (unsigned iface = 0; iface < _mesh.el->GetElementFaceNumber(iel, 0); iface++) { // I think is on all the faces that are quads
@@ -409,29 +436,19 @@ namespace femus {
 
           if (0 == _mesh.el->GetElementVertexIndex(iel, inode)) {
             _mesh.el->SetElementVertexIndex(iel, inode, ++nnodes);
-            unsigned i1 = _mesh.el->GetFaceVertexIndex(iel, iface, 0);
-            unsigned i2 = _mesh.el->GetFaceVertexIndex(iel, iface, 1);
-            unsigned i3 = _mesh.el->GetFaceVertexIndex(iel, iface, 2);
-
-            for (unsigned j = 0; j < _mesh.el->GetVertexElementNumber(i1 - 1u); j++) {
-              unsigned jel = _mesh.el->GetVertexElementIndex(i1 - 1u, j) - 1u;
-
-              if (_mesh.el->IsFatherRefined(jel) && jel > iel) {
-                for (unsigned jface = 0; jface < _mesh.el->GetElementFaceNumber(jel, 0); jface++) {
-                  unsigned jnode = _mesh.el->GetElementDofNumber(jel, 1) + jface;
-
-                  if (0 == _mesh.el->GetElementVertexIndex(jel, jnode)) {
-                    unsigned j1 = _mesh.el->GetFaceVertexIndex(jel, jface, 0);
-                    unsigned j2 = _mesh.el->GetFaceVertexIndex(jel, jface, 1);
-                    unsigned j3 = _mesh.el->GetFaceVertexIndex(jel, jface, 2);
-                    unsigned j4 = _mesh.el->GetFaceVertexIndex(jel, jface, 3);
-
-                    if ((i1 == j1 || i1 == j2 || i1 == j3 ||  i1 == j4) &&
-                        (i2 == j1 || i2 == j2 || i2 == j3 ||  i2 == j4) &&
-                        (i3 == j1 || i3 == j2 || i3 == j3 ||  i3 == j4)) {
-                      _mesh.el->SetElementVertexIndex(jel, jnode, nnodes);
-                    }
-                  }
+
+            // share the face dof with the refined element on the other side of the face
+            int jfaceGlobal = faceNeighbour[iel * maxNumberOfFaces + iface];
+
+            if (jfaceGlobal >= 0) {
+              unsigned jel = jfaceGlobal / maxNumberOfFaces;
+              unsigned jface = jfaceGlobal % maxNumberOfFaces;
+
+              if (_mesh.el->IsFatherRefined(jel)) {
+                unsigned jnode = _mesh.el->GetElementDofNumber(jel, 1) + jface;
+
+                if (0 == _mesh.el->GetElementVertexIndex(jel, jnode)) {
+                  _mesh.el->SetElementVertexIndex(jel, jnode, nnodes);
                 }
               }
             }
@@ -440,6 +457,8 @@ namespace femus {
       }
     }
 
+    faceNeighbour.resize(0);
+
     // generates element dofs for hex and quad elements
     for (unsigned iel = 0; iel < _mesh.el->GetElementNumber(); iel++) {
       if (_mesh.el->IsFatherRefined(iel)) {
@@ -61,6 +61,9 @@ private:
 
     void FlagElementsToRefine(const unsigned& type);
 
+    /** Generate the middle edge dofs of the refined elements */
+    void Buildkedge();
+
     /** To be added */
     void Buildkmid();
 
@@ -23,6 +23,7 @@
 #include "NumericVector.hpp"
 #include "FemusConfig.hpp"
 #include "MeshRefinement.hpp"
+#include "MeshMetisPartitioning.hpp"
 #include "Domain.hpp"
 
 
@@ -303,6 +304,12 @@ void MultiLevelMesh::AddAMRMeshLevel()
 }
 
 
+void MultiLevelMesh::SetAMRRebalanceThreshold(const double &threshold)
+{
+  MeshMetisPartitioning::SetRebalanceThreshold(threshold);
+}
+
+
 //---------------------------------------------------------------------------------------------
 
 void MultiLevelMesh::EraseCoarseLevels(unsigned levels_to_be_erased) {
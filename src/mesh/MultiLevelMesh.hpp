@@ -73,6 +73,10 @@ public:
 
     /** Add a partially refined mesh level in the AMR alghorithm **/
     void AddAMRMeshLevel();
+
+    /** Set the element imbalance max/average above which the partition of a new AMR level is rebalanced,
+     *  otherwise the refined elements stay on the process of their father (0 = always rebalance) */
+    void SetAMRRebalanceThreshold(const double &threshold);
     
     
     /** Get the mesh pointer to level i */
@@ -21,6 +21,9 @@
 #include <cassert>
 #include <cstdio>
 #include <fstream>
+#include <vector>
+
+#include "mpi.h"
 
 namespace femus {
 
@@ -34,6 +37,7 @@ namespace femus {
    const std::string SalomeIO::coord_list = "COO";
    const std::string SalomeIO::dofobj_indices = "NUM";
    const uint SalomeIO::max_length = 100;  ///@todo this length of the menu string is conservative enough...
+   bool SalomeIO::_collectiveRead = false;
 
 
   //How to determine a general connectivity:
@@ -105,6 +109,54 @@ const unsigned SalomeIO::SalomeToFemusFaceIndex[N_GEOM_ELS][MAX_EL_N_FACES]=
     {0,1}
   };
 
+  /** Reads the 1D dataset dtset of the given size. With the collective read each process reads its own contiguous
+   * slab with an HDF5 hyperslab (collectively when the file is opened with MPI-IO) and the slabs are then gathered,
+   * so that the file is read once and not once per process. Every process still ends with the whole dataset */
+  template <class Type>
+  static herr_t ReadDatasetBySlabs(const hid_t &dtset, const hid_t &memType, const MPI_Datatype &mpiType,
+                                   const hid_t &xferPlist, const unsigned &size, Type *data, const bool &collectiveRead) {
+
+    if(!collectiveRead) return H5Dread(dtset, memType, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+
+    int nprocs, iproc;
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &iproc);
+
+    std::vector < int > slabSize(nprocs);
+    std::vector < int > slabOffset(nprocs + 1, 0);
+    for(int jproc = 0; jproc < nprocs; jproc++) {
+      slabSize[jproc] = size / nprocs + ((unsigned)jproc < size % nprocs);
+      slabOffset[jproc + 1] = slabOffset[jproc] + slabSize[jproc];
+    }
+
+    hsize_t start[1] = {static_cast<hsize_t>(slabOffset[iproc])};
+    hsize_t count[1] = {static_cast<hsize_t>(slabSize[iproc])};
+    hsize_t memDims[1] = {(count[0] > 0) ? count[0] : 1};
+
+    hid_t filespace = H5Dget_space(dtset);
+    hid_t memspace = H5Screate_simple(1, memDims, NULL);
+    if(count[0] > 0) {
+      H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, NULL, count, NULL);
+    }
+    else {
+      H5Sselect_none(filespace);
+      H5Sselect_none(memspace);
+    }
+
+    herr_t status = H5Dread(dtset, memType, memspace, filespace, xferPlist, data + slabOffset[iproc]);
+    H5Sclose(memspace);
+    H5Sclose(filespace);
+
+    int readError = (status < 0), anyReadError;
+    MPI_Allreduce(&readError, &anyReadError, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if(anyReadError) return -1;
+
+    if(nprocs > 1) {
+      MPI_Allgatherv(MPI_IN_PLACE, 0, mpiType, data, &slabSize[0], &slabOffset[0], mpiType, MPI_COMM_WORLD);
+    }
+    return status;
+  }
+
   /// @todo extend to Wegdes (aka Prisms)
 void SalomeIO::read(const std::string& name, vector < vector < double> > &coords, const double Lref, std::vector<bool> &type_elem_flag) {
 
@@ -113,8 +165,20 @@ void SalomeIO::read(const std::string& name, vector < vector < double> > &coords
 
     hsize_t dims[2];
 
+    // with the collective read the large datasets are read by slabs, see ReadDatasetBySlabs
+    hid_t access_plist = H5P_DEFAULT;
+    hid_t xfer_plist = H5P_DEFAULT;
+#ifdef H5_HAVE_PARALLEL
+    if(_collectiveRead) {
+      access_plist = H5Pcreate(H5P_FILE_ACCESS);
+      H5Pset_fapl_mpio(access_plist, MPI_COMM_WORLD, MPI_INFO_NULL);
+      xfer_plist = H5Pcreate(H5P_DATASET_XFER);
+      H5Pset_dxpl_mpio(xfer_plist, H5FD_MPIO_COLLECTIVE);
+    }
+#endif
+
    // compute number of menus ===============
-    hid_t  file_id = H5Fopen(name.c_str(),H5F_ACC_RDWR, H5P_DEFAULT);
+    hid_t  file_id = H5Fopen(name.c_str(), H5F_ACC_RDONLY, access_plist);
 
     hid_t  gid = H5Gopen(file_id,mesh_ensemble.c_str(),H5P_DEFAULT);
 
@@ -195,7 +259,8 @@ void SalomeIO::read(const std::string& name, vector < vector < double> > &coords
     coords[1].resize(n_nodes);
     coords[2].resize(n_nodes);
 
-  status=H5Dread(dtset,H5T_NATIVE_DOUBLE,H5S_ALL,H5S_ALL,H5P_DEFAULT,xyz_med);
+  status=ReadDatasetBySlabs(dtset,H5T_NATIVE_DOUBLE,MPI_DOUBLE,xfer_plist,dims[0],xyz_med,_collectiveRead);
+  if(status < 0) {std::cout << "SalomeIO::read: coordinates not found"; abort();}
   H5Dclose(dtset);
 
    if (mesh.GetDimension()==3) {
@@ -246,7 +311,7 @@ void SalomeIO::read(const std::string& name, vector < vector < double> > &coords
 
   int * conn_map = new  int[dim_conn];
   std::cout << " Number of elements in med file " <<  n_elements <<  std::endl;
-  status=H5Dread(dtset2,H5T_NATIVE_INT,H5S_ALL,H5S_ALL,H5P_DEFAULT,conn_map);
+  status=ReadDatasetBySlabs(dtset2,H5T_NATIVE_INT,MPI_INT,xfer_plist,dim_conn,conn_map,_collectiveRead);
   if(status !=0) {std::cout << "SalomeIO::read: connectivity not found"; abort();}
   H5Dclose(dtset2);
 
@@ -343,7 +408,8 @@ void SalomeIO::read(const std::string& name, vector < vector < double> > &coords
   hid_t filespace = H5Dget_space(dtset);
   hid_t status  = H5Sget_simple_extent_dims(filespace, dims, NULL);
   int * elem_indices = new int[dims[0]];
-  status=H5Dread(dtset,H5T_NATIVE_INT,H5S_ALL,H5S_ALL,H5P_DEFAULT,elem_indices);
+  status=ReadDatasetBySlabs(dtset,H5T_NATIVE_INT,MPI_INT,xfer_plist,dims[0],elem_indices,_collectiveRead);
+  if(status < 0) {std::cout << "SalomeIO::read: group elements not found"; abort();}
 
   for (unsigned i=0; i < dims[0]; i++) {
            mesh.el->SetElementGroup(elem_indices[i] -1 - n_elements_b_bb, gr_name);
@@ -359,6 +425,12 @@ void SalomeIO::read(const std::string& name, vector < vector < double> > &coords
 
 
     status = H5Fclose(file_id);
+#ifdef H5_HAVE_PARALLEL
+    if(_collectiveRead) {
+      H5Pclose(xfer_plist);
+      H5Pclose(access_plist);
+    }
+#endif
 
     //loop over volume elements
     //extract faces
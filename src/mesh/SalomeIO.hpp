@@ -55,6 +55,12 @@ class SalomeIO : public MeshInput<Mesh>
    */
   virtual void read (const std::string& name, vector < vector < double> > &coords, const double Lref, std::vector<bool> &type_elem_flag);
 
+  /** Read the coordinates, the connectivity and the groups by slabs shared among the processes and gathered on all
+   *  of them (with MPI-IO when HDF5 is parallel): less contention on the file, the same memory on each process */
+  static void SetCollectiveRead(const bool &value) {
+    _collectiveRead = value;
+  };
+
  private:
    
    /** Map from Salome vertex index to Femus vertex index */
@@ -83,6 +89,9 @@ class SalomeIO : public MeshInput<Mesh>
    static const std::string dofobj_indices;   //NUM
    static const uint max_length;
 
+   /** a flag for the collective read of the large datasets */
+   static bool _collectiveRead;
+
 };
 
 
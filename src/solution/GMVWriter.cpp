@@ -26,12 +26,104 @@
 #include <algorithm>
 #include <cstring>
 #include "Files.hpp"
+#include "OutputQueue.hpp"
 
 
 namespace femus {
 
 
 
+/**
+ * Print the "fromfile" keyword followed by the quoted name of the gmv file from which the current section
+ * (nodes or cells) is read, in place of the section data
+ **/
+static void PrintFromFile(std::ostream &fout, const std::string &filename) {
+  fout.write("fromfile",sizeof(char)*8);
+  std::string quotedName = "\"" + filename + "\"";
+  fout.write(quotedName.c_str(),sizeof(char)*quotedName.size());
+}
+
+/** Merge the gmv files written by Pwrite for the processes of a group: nodes, cells and variables are concatenated
+ * and the connectivity is shifted by the nodes of the previous pieces. info holds the nodes and the cells of each piece */
+static void MergeGMVPieces(const std::vector < std::string > &pieces, const std::vector < unsigned > &info, std::string &merged) {
+
+  const unsigned nPieces = pieces.size();
+  const size_t keyword = 8*sizeof(char);
+
+  unsigned nvtTotal = 0;
+  unsigned nelTotal = 0;
+  for (unsigned j=0; j<nPieces; j++) {
+    nvtTotal += info[2*j];
+    nelTotal += info[2*j+1];
+  }
+
+  // header gmvinput ieeei4r8
+  std::vector < size_t > pos(nPieces, 2*keyword);
+  merged.assign(pieces[0], 0, 2*keyword);
+
+  // nodes and cells
+  for (unsigned section=0; section<2; section++) {
+    merged.append(pieces[0], pos[0], keyword);
+    for (unsigned j=0; j<nPieces; j++) pos[j] += keyword;
+
+    if( pieces[0].compare(pos[0], keyword, "fromfile") == 0 ) { // static mesh: all the pieces refer to the file of the group
+      size_t end = pieces[0].find('"', pos[0] + keyword + 1u);
+      merged.append(pieces[0], pos[0], end + 1u - pos[0]);
+      for (unsigned j=0; j<nPieces; j++) pos[j] = pieces[j].find('"', pos[j] + keyword + 1u) + 1u;
+    }
+    else if( section == 0 ) {
+      merged.append((const char *)&nvtTotal, sizeof(unsigned));
+      for (unsigned j=0; j<nPieces; j++) pos[j] += sizeof(unsigned);
+      for (int i=0; i<3; i++) {
+        for (unsigned j=0; j<nPieces; j++) {
+          merged.append(pieces[j], pos[j], info[2*j]*sizeof(double));
+          pos[j] += info[2*j]*sizeof(double);
+        }
+      }
+    }
+    else {
+      merged.append((const char *)&nelTotal, sizeof(unsigned));
+      unsigned nodeOffset = 0;
+      for (unsigned j=0; j<nPieces; j++) {
+        pos[j] += sizeof(unsigned);
+        for (unsigned iel=0; iel<info[2*j+1]; iel++) {
+          unsigned nve;
+          merged.append(pieces[j], pos[j], keyword);
+          memcpy(&nve, &pieces[j][pos[j] + keyword], sizeof(unsigned));
+          merged.append(pieces[j], pos[j] + keyword, sizeof(unsigned));
+          pos[j] += keyword + sizeof(unsigned);
+          for (unsigned i=0; i<nve; i++) {
+            unsigned node;
+            memcpy(&node, &pieces[j][pos[j]], sizeof(unsigned));
+            node += nodeOffset;
+            merged.append((const char *)&node, sizeof(unsigned));
+            pos[j] += sizeof(unsigned);
+          }
+        }
+        nodeOffset += info[2*j];
+      }
+    }
+  }
+
+  // variables, in the same order in all the pieces
+  merged.append(pieces[0], pos[0], keyword);
+  for (unsigned j=0; j<nPieces; j++) pos[j] += keyword;
+  while( pieces[0].compare(pos[0], 7, "endvars") != 0 ) {
+    unsigned onNodes;
+    memcpy(&onNodes, &pieces[0][pos[0] + keyword], sizeof(unsigned));
+    merged.append(pieces[0], pos[0], keyword + sizeof(unsigned));
+    for (unsigned j=0; j<nPieces; j++) {
+      pos[j] += keyword + sizeof(unsigned);
+      size_t size = info[2*j + (onNodes == 0)]*sizeof(double);
+      merged.append(pieces[j], pos[j], size);
+      pos[j] += size;
+    }
+  }
+
+  // endvars endgmv
+  merged.append(pieces[0], pos[0], std::string::npos);
+}
+
 GMVWriter::GMVWriter(MultiLevelSolution * ml_sol): Writer(ml_sol)
 {
   _debugOutput = false;
@@ -49,6 +141,9 @@ GMVWriter::~GMVWriter()
 
 void GMVWriter::write(const std::string output_path, const char order[], const std::vector<std::string>& vars, const unsigned time_step) {
 
+  ClearOutputSolutions();
+  if( _outputRegion ) std::cout << "Warning the GMV writer does not have region output, the whole level is printed" << std::endl;
+
   unsigned igridn = _gridn; // aggiunta da me
 
   if (igridn==0) igridn=_gridn;
@@ -65,6 +160,10 @@ void GMVWriter::write(const std::string output_path, const char order[], const s
   std::ostringstream filename;
     filename << output_path << "/" << filename_prefix << ".level" << _gridn << "." << time_step << "." << order << ".gmv";
 
+  bool writeMesh = MeshHasToBeWritten(output_path, index, time_step);
+  std::ostringstream meshFilename;
+  meshFilename << filename_prefix << ".level" << _gridn << "." << _meshTimeStep[index] << "." << order << ".gmv";
+
   std::ofstream fout;
 
   if(_iproc!=0) {
@@ -106,44 +205,49 @@ void GMVWriter::write(const std::string output_path, const char order[], const s
   // ********** Start printing node coordinates  **********
   sprintf(det,"%s","nodes");
   fout.write((char *)det,sizeof(char)*8);
-  fout.write((char *)&nvt,sizeof(unsigned));
-
-  for (int i=0; i<3; i++) {
-    for (unsigned ig=igridr-1u; ig<igridn; ig++) {
-      if(!_surface){
-	Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
-        if(_graph && i == 2){
-	  unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
-	  Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indGraphVar],
-				 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
-	}
-      }
-      else{
-	unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
-        Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indSurfVar],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
-      }
+  if( !writeMesh ){ // the static mesh is read from the file where it has been printed
+    PrintFromFile(fout, meshFilename.str());
+  }
+  else {
+    fout.write((char *)&nvt,sizeof(unsigned));
+
+    for (int i=0; i<3; i++) {
+      for (unsigned ig=igridr-1u; ig<igridn; ig++) {
+        if(!_surface){
+          Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
+          if(_graph && i == 2){
+            unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
+            Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indGraphVar),
+                                   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
+          }
+        }
+        else{
+          unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
+          Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indSurfVar),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
+        }
 
-      vector <double> v_local;
-      Mysol[ig]->localize_to_one(v_local,0);
-      unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-      if(_iproc==0){
-	for (unsigned ii=0; ii<nvt_ig; ii++)
-	  var_nd[ii]= v_local[ii];
-      }
-      if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  {
-	unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
-	Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indDXDYDZ],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index, _ml_sol->GetSolutionType(indDXDYDZ)) );
-	Mysol[ig]->localize_to_one(v_local,0);
-	unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-	if(_iproc==0){
-	  for (unsigned ii=0; ii<nvt_ig; ii++)
-	    var_nd[ii]+= v_local[ii];
-	}
+        vector <double> v_local;
+        Mysol[ig]->localize_to_one(v_local,0);
+        unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+        if(_iproc==0){
+          for (unsigned ii=0; ii<nvt_ig; ii++)
+            var_nd[ii]= v_local[ii];
+        }
+        if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  {
+          unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indDXDYDZ),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index, _ml_sol->GetSolutionType(indDXDYDZ)) );
+          Mysol[ig]->localize_to_one(v_local,0);
+          unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+          if(_iproc==0){
+            for (unsigned ii=0; ii<nvt_ig; ii++)
+              var_nd[ii]+= v_local[ii];
+          }
+        }
+        fout.write((char *)&var_nd[0],nvt_ig*sizeof(double));
       }
-      fout.write((char *)&var_nd[0],nvt_ig*sizeof(double));
     }
   }
   // ********** End printing node coordinates  **********
@@ -157,50 +261,55 @@ void GMVWriter::write(const std::string output_path, const char order[], const s
   for (unsigned ig=igridr-1u; ig<igridn-1u; ig++)
     nel+=( _ml_mesh->GetLevel(ig)->GetNumberOfElements() - _ml_mesh->GetLevel(ig)->el->GetRefinedElementNumber());
   nel+=_ml_mesh->GetLevel(igridn-1u)->GetNumberOfElements();
-  fout.write((char *)&nel,sizeof(unsigned));
+  if( !writeMesh ){
+    PrintFromFile(fout, meshFilename.str());
+  }
+  else {
+    fout.write((char *)&nel,sizeof(unsigned));
 
-  unsigned topology[27];
-  unsigned offset=1;
+    unsigned topology[27];
+    unsigned offset=1;
 
-  vector < double > localizedElementType;
-  _ml_mesh->GetLevel(igridn-1)->_topology->_Sol[_ml_mesh->GetLevel(igridn-1)->GetTypeIndex()]->localize_to_one(localizedElementType, 0);
+    vector < double > localizedElementType;
+    _ml_mesh->GetLevel(igridn-1)->_topology->_Sol[_ml_mesh->GetLevel(igridn-1)->GetTypeIndex()]->localize_to_one(localizedElementType, 0);
   
-  if(_iproc == 0){
-    for (unsigned ig=igridr-1u; ig<igridn; ig++) {
-      for (unsigned ii=0; ii<_ml_mesh->GetLevel(ig)->GetNumberOfElements(); ii++) {
-	if ( ig == igridn-1u ) {
-	  short unsigned ielt = static_cast < short unsigned > (localizedElementType[ii]+ 0.25);
-	  //short unsigned ielt=_ml_mesh->GetLevel(ig)->el->GetElementType(ii);
-	  if (ielt==0) sprintf(det,"phex%d",eltp[index][0]);
-	  else if (ielt==1) sprintf(det,"ptet%d",eltp[index][1]);
-	  else if (ielt==2) sprintf(det,"pprism%d",eltp[index][2]);
-	  else if (ielt==3) {
-	    if (eltp[index][3]==8) sprintf(det,"%dquad",eltp[index][3]);
-	    else sprintf(det,"quad");
-	  } else if (ielt==4) {
-	    if (eltp[index][4]==6) sprintf(det,"%dtri",eltp[index][4]);
-	    else sprintf(det,"tri");
-	  } else if (ielt==5) {
-	    if (eltp[index][5]==3) sprintf(det,"%dline",eltp[index][5]);
-	    else sprintf(det,"line");
-	  }
-	  fout.write((char *)det,sizeof(char)*8);
-	  fout.write((char *)&NVE[ielt][index],sizeof(unsigned));
-	  for(unsigned j=0;j<NVE[ielt][index];j++){
-
-	    //unsigned jnode=_ml_mesh->GetLevel(ig)->el->GetElementVertexIndex(ii,j)-1u;
-	    unsigned jnode_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(j,ii,index);
-
-	    topology[j]=jnode_Metis+offset;
-	  }
-	  fout.write((char *)topology,sizeof(unsigned)*NVE[ielt][index]);
-	}
+    if(_iproc == 0){
+      for (unsigned ig=igridr-1u; ig<igridn; ig++) {
+        for (unsigned ii=0; ii<_ml_mesh->GetLevel(ig)->GetNumberOfElements(); ii++) {
+          if ( ig == igridn-1u ) {
+            short unsigned ielt = static_cast < short unsigned > (localizedElementType[ii]+ 0.25);
+            //short unsigned ielt=_ml_mesh->GetLevel(ig)->el->GetElementType(ii);
+            if (ielt==0) sprintf(det,"phex%d",eltp[index][0]);
+            else if (ielt==1) sprintf(det,"ptet%d",eltp[index][1]);
+            else if (ielt==2) sprintf(det,"pprism%d",eltp[index][2]);
+            else if (ielt==3) {
+              if (eltp[index][3]==8) sprintf(det,"%dquad",eltp[index][3]);
+              else sprintf(det,"quad");
+            } else if (ielt==4) {
+              if (eltp[index][4]==6) sprintf(det,"%dtri",eltp[index][4]);
+              else sprintf(det,"tri");
+            } else if (ielt==5) {
+              if (eltp[index][5]==3) sprintf(det,"%dline",eltp[index][5]);
+              else sprintf(det,"line");
+            }
+            fout.write((char *)det,sizeof(char)*8);
+            fout.write((char *)&NVE[ielt][index],sizeof(unsigned));
+            for(unsigned j=0;j<NVE[ielt][index];j++){
+
+              //unsigned jnode=_ml_mesh->GetLevel(ig)->el->GetElementVertexIndex(ii,j)-1u;
+              unsigned jnode_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(j,ii,index);
+
+              topology[j]=jnode_Metis+offset;
+            }
+            fout.write((char *)topology,sizeof(unsigned)*NVE[ielt][index]);
+          }
+        }
+        offset+=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
       }
-      offset+=_ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
     }
-  }
   
-  localizedElementType.resize(0);
+    localizedElementType.resize(0);
+  }
   // ********** End printing cell connectivity  **********
 
   double *var_el=new double [nel+1]; //TO FIX Valgrind complaints! In reality it should be only nel
@@ -279,7 +388,7 @@ void GMVWriter::write(const std::string output_path, const char order[], const s
 	  fout.write((char *)&one,sizeof(unsigned));
 	  for (unsigned ig=igridr-1u; ig<igridn; ig++) {
 	    if (name==0){
-	      Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[i],
+	      Mysol[ig]->matrix_mult(*GetOutputSolution(ig, i),
 				     *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index, _ml_sol->GetSolutionType(i)) );
 	    }
 	    else if (name==1){
@@ -306,7 +415,7 @@ void GMVWriter::write(const std::string output_path, const char order[], const s
 	  for (unsigned ig=igridr-1u; ig<igridn; ig++) {
 	    std::vector<double> v_local;
 	    if (name==0){
-	      _ml_sol->GetSolutionLevel(ig)->_Sol[i]->localize_to_one(v_local,0);
+	      GetOutputSolution(ig, i)->localize_to_one(v_local,0);
 	    }
 	    else if (name==1){
 	      _ml_sol->GetSolutionLevel(ig)->_Bdc[i]->localize_to_one(v_local,0);
@@ -361,6 +470,9 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
     return;
   }
 
+  ClearOutputSolutions();
+  if( _outputRegion ) std::cout << "Warning the GMV writer does not have region output, the whole level is printed" << std::endl;
+
   unsigned gridn = _gridn; // aggiunta da me
 
   if ( gridn == 0 ) gridn = _gridn;
@@ -379,14 +491,24 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
   else filename_prefix = "mesh";
 
   std::ostringstream filename;
-  filename << output_path << "/" << dirnamePGMV << filename_prefix << ".level" << _gridn << "." <<_iproc<<"."<< time_step << "." << order << ".gmv";
+  filename << output_path << "/" << dirnamePGMV << filename_prefix << ".level" << _gridn << "." <<GetOutputFileIndex()<<"."<< time_step << "." << order << ".gmv";
 
-  std::ofstream fout;
+  bool writeMesh = MeshHasToBeWritten(output_path + "/" + dirnamePGMV, index, time_step);
+  std::ostringstream meshFilename;
+  meshFilename << filename_prefix << ".level" << _gridn << "." <<GetOutputFileIndex()<<"."<< _meshTimeStep[index] << "." << order << ".gmv";
+
+  // with asynchronous or aggregated output the gmv file is staged in memory
+  bool staged = ( _outputQueue != NULL || _aggregatedOutput );
+  std::ofstream ffout;
+  std::ostringstream sfout;
+  std::ostream &fout = ( staged ) ? static_cast < std::ostream& > (sfout) : ffout;
 
-  fout.open(filename.str().c_str());
-  if (!fout.is_open()) {
-    std::cout << std::endl << " The output file "<< filename.str() <<" cannot be opened.\n";
-    abort();
+  if( !staged ) {
+    ffout.open(filename.str().c_str());
+    if (!ffout.is_open()) {
+      std::cout << std::endl << " The output file "<< filename.str() <<" cannot be opened.\n";
+      abort();
+    }
   }
 
   //count the own node dofs on all levels
@@ -460,76 +582,81 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
   // ********** Start printing node coordinates  **********
   sprintf(det,"%s","nodes");
   fout.write((char *)det,sizeof(char)*8);
-  fout.write((char *)&nvt,sizeof(unsigned));
-
-  for (int i=0; i<3; i++) {
-    for (unsigned ig=igridr-1u; ig<gridn; ig++) {
-      if(!_surface){
-	Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
-	if( _graph && i == 2){
-	  unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
-	  Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indGraphVar],
-				 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
-	}
-      }
-      else {
-        unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
-        Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indSurfVar],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
-      }
-      unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
-      unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
-      for (unsigned ii=0; ii<nvt_ig; ii++)
-	var_nd[ii]= (*Mysol[ig])(ii + offset_iprc);
-      if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  { // if moving mesh
-	unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
-	Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indDXDYDZ],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
- 	for (unsigned ii=0; ii<nvt_ig; ii++)
- 	  var_nd[ii]+= (*Mysol[ig])(ii + offset_iprc);
-      }
-      fout.write( (char *)&var_nd[0], nvt_ig*sizeof(double) );
-    }
-    //print ghost coordinates
+  if( !writeMesh ){ // the static mesh is read from the file where it has been printed
+    PrintFromFile(fout, meshFilename.str());
+  }
+  else {
+    fout.write((char *)&nvt,sizeof(unsigned));
 
-    gridOffset = 0;
-    unsigned ig = igridr-1u;
-    for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
-      while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
-	gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-	ig++;
-      }
-      var_nd[ it->second ] = (*Mysol[ig])( it->first - gridOffset);
-    }
-    if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i) { // if moving mesh
+    for (int i=0; i<3; i++) {
       for (unsigned ig=igridr-1u; ig<gridn; ig++) {
-	if(!_surface){
-	  Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
-	  if( _graph && i == 2){
-	    unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
-	    Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indGraphVar],
-				 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
-	  }
-	}
-	else {
-	  unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
-	  Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indSurfVar],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
-	}
+        if(!_surface){
+          Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
+          if( _graph && i == 2){
+            unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
+            Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indGraphVar),
+                                   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
+          }
+        }
+        else {
+          unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
+          Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indSurfVar),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
+        }
+        unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
+        unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
+        for (unsigned ii=0; ii<nvt_ig; ii++)
+          var_nd[ii]= (*Mysol[ig])(ii + offset_iprc);
+        if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  { // if moving mesh
+          unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indDXDYDZ),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
+          for (unsigned ii=0; ii<nvt_ig; ii++)
+            var_nd[ii]+= (*Mysol[ig])(ii + offset_iprc);
+        }
+        fout.write( (char *)&var_nd[0], nvt_ig*sizeof(double) );
       }
+      //print ghost coordinates
+
       gridOffset = 0;
       unsigned ig = igridr-1u;
       for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
-	while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
-	  gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-	  ig++;
-	}
-	var_nd[ it->second ] += (*Mysol[ig])( it->first - gridOffset);
+        while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
+          gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+          ig++;
+        }
+        var_nd[ it->second ] = (*Mysol[ig])( it->first - gridOffset);
       }
+      if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i) { // if moving mesh
+        for (unsigned ig=igridr-1u; ig<gridn; ig++) {
+          if(!_surface){
+            Mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
+            if( _graph && i == 2){
+              unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
+              Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indGraphVar),
+                                   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
+            }
+          }
+          else {
+            unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
+            Mysol[ig]->matrix_mult(*GetOutputSolution(ig, indSurfVar),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
+          }
+        }
+        gridOffset = 0;
+        unsigned ig = igridr-1u;
+        for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
+          while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
+            gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+            ig++;
+          }
+          var_nd[ it->second ] += (*Mysol[ig])( it->first - gridOffset);
+        }
+      }
+      fout.write( (char *)&var_nd[0], ghostMap.size()*sizeof(double) );
     }
-    fout.write( (char *)&var_nd[0], ghostMap.size()*sizeof(double) );
   }
   // ********** End printing node coordinates  **********
 
@@ -537,46 +664,51 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
   const int eltp[2][6]= {{8,4,6,4,3,2},{20,10,15,8,6,3}};
   sprintf(det,"%s","cells");
   fout.write((char *)det,sizeof(char)*8);
-  fout.write((char *)&nel,sizeof(unsigned));
+  if( !writeMesh ){
+    PrintFromFile(fout, meshFilename.str());
+  }
+  else {
+    fout.write((char *)&nel,sizeof(unsigned));
 
-  unsigned topology[27];
-  unsigned offset=1;
+    unsigned topology[27];
+    unsigned offset=1;
 
-  gridOffset = 0;
-  for (unsigned ig=igridr-1u; ig<gridn; ig++) {
-    unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
-    unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
-    for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == gridn-1u ) {
-	short unsigned ielt=_ml_mesh->GetLevel(ig)->GetElementType(iel);
-        if (ielt==0) sprintf(det,"phex%d",eltp[index][0]);
-        else if (ielt==1) sprintf(det,"ptet%d",eltp[index][1]);
-        else if (ielt==2) sprintf(det,"pprism%d",eltp[index][2]);
-        else if (ielt==3) {
-          if (eltp[index][3]==8) sprintf(det,"%dquad",eltp[index][3]);
-          else sprintf(det,"quad");
-        }
-        else if (ielt==4) {
-          if (eltp[index][4]==6) sprintf(det,"%dtri",eltp[index][4]);
-          else sprintf(det,"tri");
-        }
-        else if (ielt==5) {
-          if (eltp[index][5]==3) sprintf(det,"%dline",eltp[index][5]);
-          else sprintf(det,"line");
+    gridOffset = 0;
+    for (unsigned ig=igridr-1u; ig<gridn; ig++) {
+      unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
+      unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
+      for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
+        if ( ig == gridn-1u ) {
+          short unsigned ielt=_ml_mesh->GetLevel(ig)->GetElementType(iel);
+          if (ielt==0) sprintf(det,"phex%d",eltp[index][0]);
+          else if (ielt==1) sprintf(det,"ptet%d",eltp[index][1]);
+          else if (ielt==2) sprintf(det,"pprism%d",eltp[index][2]);
+          else if (ielt==3) {
+            if (eltp[index][3]==8) sprintf(det,"%dquad",eltp[index][3]);
+            else sprintf(det,"quad");
+          }
+          else if (ielt==4) {
+            if (eltp[index][4]==6) sprintf(det,"%dtri",eltp[index][4]);
+            else sprintf(det,"tri");
+          }
+          else if (ielt==5) {
+            if (eltp[index][5]==3) sprintf(det,"%dline",eltp[index][5]);
+            else sprintf(det,"line");
+          }
+          fout.write((char *)det,sizeof(char)*8);
+          fout.write((char *)&NVE[ielt][index],sizeof(unsigned));
+          for(unsigned j=0;j<NVE[ielt][index];j++){
+
+            unsigned jnodeMetis = _ml_mesh->GetLevel(ig)->GetSolutionDof(j, iel, index);
+            topology[j]=(jnodeMetis >= offset_iprc )? jnodeMetis - offset_iprc + offset :
+                                                       nvt0 + ghostMap[gridOffset+jnodeMetis] + 1u;
+          }
+          fout.write((char *)topology,sizeof(unsigned)*NVE[ielt][index]);
         }
-        fout.write((char *)det,sizeof(char)*8);
-        fout.write((char *)&NVE[ielt][index],sizeof(unsigned));
-	for(unsigned j=0;j<NVE[ielt][index];j++){
-
-	  unsigned jnodeMetis = _ml_mesh->GetLevel(ig)->GetSolutionDof(j, iel, index);
-	  topology[j]=(jnodeMetis >= offset_iprc )? jnodeMetis - offset_iprc + offset :
-						     nvt0 + ghostMap[gridOffset+jnodeMetis] + 1u;
-	}
-	fout.write((char *)topology,sizeof(unsigned)*NVE[ielt][index]);
       }
+      offset += nvt_ig;
+      gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
     }
-    offset += nvt_ig;
-    gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
   }
   // ********** End printing cell connectivity  **********
 
@@ -651,7 +783,7 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
 	  fout.write((char *)&one,sizeof(unsigned));
 	  for (unsigned ig=igridr-1u; ig<gridn; ig++) {
 	    if (name==0){
-	      Mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[i],
+	      Mysol[ig]->matrix_mult(*GetOutputSolution(ig, i),
 				     *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index, _ml_sol->GetSolutionType(i)) );
 	    }
 	    else if (name==1){
@@ -694,7 +826,7 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
 		unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0, iel,_ml_sol->GetSolutionType(i));
 		if ( ig==gridn-1u ) {
 		  if (name==0){
-		    var_el[icount] = (*_ml_sol->GetSolutionLevel(ig)->_Sol[i])(iel_Metis);
+		    var_el[icount] = (*GetOutputSolution(ig, i))(iel_Metis);
 		  }
 		  else if (name==1){
 		    var_el[icount] = (*_ml_sol->GetSolutionLevel(ig)->_Bdc[i])(iel_Metis);
@@ -724,7 +856,27 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
   // ********** End printing Variables **********
   sprintf(det,"%s","endgmv");
   fout.write((char *)det,sizeof(char)*8);
-  fout.close();
+  if( _aggregatedOutput ) {
+    // the first process of the group merges the pieces of all the processes of the group in its file
+    std::string stagingBuffer = sfout.str();
+    std::vector < unsigned > info(2);
+    info[0] = nvt;
+    info[1] = nel;
+    std::vector < std::string > groupPieces;
+    std::vector < unsigned > groupInfo;
+    if( GatherGroupPieces(stagingBuffer, info, groupPieces, groupInfo) ) {
+      std::string fileBuffer;
+      MergeGMVPieces(groupPieces, groupInfo, fileBuffer);
+      WriteStagedFile(filename.str(), fileBuffer);
+    }
+  }
+  else if( _outputQueue != NULL ) {
+    std::string stagingBuffer = sfout.str();
+    _outputQueue->Push(filename.str(), stagingBuffer);
+  }
+  else {
+    ffout.close();
+  }
   // ********** End printing file **********
 
   // Free memory
@@ -757,10 +909,11 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
   // *********** write pvtu header ***********
   Pfout<< "<?xml version=\"1.0\"?>" << std::endl;
   Pfout<< "<pqevents>\n";
-  for(int jproc=0;jproc<_nprocs;jproc++){
+  const unsigned nFiles = GetNumberOfOutputFiles();
+  for(unsigned jfile=0;jfile<nFiles;jfile++){
     Pfout<< "  <pqevent object=\"pqClientMainWindow/MainControlsToolbar/1QToolButton0\" command=\"activate\" arguments=\"\" />\n";
     Pfout<< "  <pqevent object=\"pqClientMainWindow/FileOpenDialog\" command=\"filesSelected\" arguments=\"";
-    Pfout<< dirnamePGMV << filename_prefix << ".level" << _gridn << "." <<jproc<<"."<< time_step << "." << order << ".gmv\" />\n";
+    Pfout<< dirnamePGMV << filename_prefix << ".level" << _gridn << "." <<jfile<<"."<< time_step << "." << order << ".gmv\" />\n";
   }
 
   Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,50,5,/0:0\" />\n";
@@ -768,28 +921,28 @@ void GMVWriter::Pwrite(const std::string output_path, const char order[], const
 
   Pfout<< "  <pqevent object=\"pqClientMainWindow/propertiesDock/propertiesPanel/Accept\" command=\"activate\"   arguments=\"\" />\n";
 
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,33554432,50,5,/0:0/"<<_nprocs-1<<":0\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,33554432,50,5,/0:0/"<<_nprocs-1<<":0\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,33554432,50,5,/0:0/"<<nFiles-1<<":0\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,33554432,50,5,/0:0/"<<nFiles-1<<":0\" />\n";
   Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"keyEvent\" 	 arguments=\"7,16777248,0,,0,1\" />\n";
   Pfout<< "  <pqevent object=\"pqClientMainWindow/menubar\" command=\"activate\" arguments=\"menuFilters\" />\n";
   Pfout<< "  <pqevent object=\"pqClientMainWindow/menubar/menuFilters/Alphabetical\" command=\"activate\"        arguments=\"GroupDataSets\" />\n";
 
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
 
   Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,33554432,25,5,/0:0\" />\n";
   Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,33554432,25,5,/0:0\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,33554432,50,5,/0:0/"<<_nprocs<<":0\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,33554432,50,5,/0:0/"<<_nprocs<<":0\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,33554432,50,5,/0:0/"<<nFiles<<":0\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,33554432,50,5,/0:0/"<<nFiles<<":0\" />\n";
   Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"keyEvent\"     arguments=\"7,16777248,0,,0,1\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
 
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,50,5,/0:0/"<<_nprocs<<":1\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,50,5,/0:0/"<<_nprocs<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,50,5,/0:0/"<<nFiles<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,50,5,/0:0/"<<nFiles<<":1\" />\n";
 
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
-  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<_nprocs<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mousePress\"   arguments=\"1,1,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
+  Pfout<< "  <pqevent object=\"pqClientMainWindow/pipelineBrowserDock/pipelineBrowser\" command=\"mouseRelease\" arguments=\"1,0,0,10,5,/0:0/"<<nFiles<<":1\" />\n";
 
   Pfout<< "</pqevents>\n";
   Pfout.close();
@@ -53,6 +53,9 @@ namespace femus {
       /** Set if to print or not to prind the debugging variables */
       void SetDebugOutput( bool value ){ _debugOutput = value;}
 
+      /** Write the parallel gmv files in background while the computation goes on (the staging stays in the time loop) */
+      void SetAsynchronousOutput(const unsigned &maxPendingWrites){ StartOutputQueue(maxPendingWrites); };
+
   private:
 
     bool _debugOutput;
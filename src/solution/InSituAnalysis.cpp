@@ -0,0 +1,374 @@
+/*=========================================================================
+
+ Program: FEMUS
+ Module: InSituAnalysis
+ Authors: Eugenio Aulisa, Simone Bnà
+
+ Copyright (c) FEMTTU
+ All rights reserved.
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+//----------------------------------------------------------------------------
+// includes :
+//----------------------------------------------------------------------------
+#include "InSituAnalysis.hpp"
+#include "MultiLevelSolution.hpp"
+#include "ElemType.hpp"
+#include "NumericVector.hpp"
+#include "SparseMatrix.hpp"
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <cmath>
+#include "mpi.h"
+
+
+namespace femus {
+
+
+  InSituAnalysis::InSituAnalysis(MultiLevelSolution *ml_sol): _ml_sol(ml_sol) {
+    _probeLevel = -1;
+  }
+
+  InSituAnalysis::~InSituAnalysis() {
+    if( _fout.is_open() ) _fout.close();
+  }
+
+
+  std::vector < unsigned > InSituAnalysis::GetVariableIndices(const std::vector < std::string > &variables, const bool &lagrangeOnly) const {
+    std::vector < unsigned > solIndex(variables.size());
+    for( unsigned i = 0; i < variables.size(); i++ ) {
+      solIndex[i] = _ml_sol->GetIndex(variables[i].c_str());
+      unsigned solType = _ml_sol->GetSolutionType(solIndex[i]);
+      if( solType > 3 || ( lagrangeOnly && solType > 2 ) ) {
+        std::cout << "Error! The in-situ analysis does not support the finite element type of " << variables[i] << std::endl;
+        abort();
+      }
+    }
+    return solIndex;
+  }
+
+
+  void InSituAnalysis::AddVolumeIntegral(const std::string &name, const std::vector < std::string > &variables,
+                                         VolumeFunctional functional, const int &group) {
+    AnalysisQuantity quantity;
+    quantity.name = name;
+    quantity.kind = VOLUME_INTEGRAL;
+    quantity.solIndex = GetVariableIndices(variables, false);
+    quantity.volumeFunctional = functional;
+    quantity.boundaryFunctional = NULL;
+    quantity.region = group;
+    quantity.probeProc = -1;
+    quantity.probeDof = 0;
+    _quantities.push_back(quantity);
+  }
+
+
+  void InSituAnalysis::AddBoundaryIntegral(const std::string &name, const std::vector < std::string > &variables,
+                                           BoundaryFunctional functional, const int &faceIndex) {
+    AnalysisQuantity quantity;
+    quantity.name = name;
+    quantity.kind = BOUNDARY_INTEGRAL;
+    quantity.solIndex = GetVariableIndices(variables, true);
+    quantity.volumeFunctional = NULL;
+    quantity.boundaryFunctional = functional;
+    quantity.region = faceIndex;
+    quantity.probeProc = -1;
+    quantity.probeDof = 0;
+    _quantities.push_back(quantity);
+  }
+
+
+  void InSituAnalysis::AddProbe(const std::string &name, const std::string &variable, const std::vector < double > &x) {
+    AnalysisQuantity quantity;
+    quantity.name = name;
+    quantity.kind = PROBE;
+    quantity.solIndex = GetVariableIndices(std::vector < std::string > (1, variable), true);
+    quantity.volumeFunctional = NULL;
+    quantity.boundaryFunctional = NULL;
+    quantity.region = 0;
+    quantity.point = x;
+    quantity.point.resize(3, 0.);
+    quantity.probeProc = -1;
+    quantity.probeDof = 0;
+    _quantities.push_back(quantity);
+    _probeLevel = -1;
+  }
+
+
+  void InSituAnalysis::SetOutputFile(const std::string &filename) {
+    if( _fout.is_open() ) _fout.close();
+    _filename = filename;
+  }
+
+
+  double InSituAnalysis::GetValue(const std::string &name) const {
+    for( unsigned i = 0; i < _quantities.size(); i++ ) {
+      if( _quantities[i].name == name ) return ( i < _values.size() ) ? _values[i] : 0.;
+    }
+    std::cout << "Error! The in-situ quantity " << name << " has not been added" << std::endl;
+    abort();
+  }
+
+
+  void InSituAnalysis::LocateProbes(const unsigned &level) {
+
+    Mesh *msh = _ml_sol->_mlMesh->GetLevel(level);
+    unsigned dim = msh->GetDimension();
+
+    for( unsigned q = 0; q < _quantities.size(); q++ ) {
+      if( _quantities[q].kind != PROBE ) continue;
+
+      struct {
+        double distance;
+        int proc;
+      } closest, globalClosest;
+
+      closest.distance = 1.0e+300;
+      closest.proc = _iproc;
+      unsigned closestDof = 0;
+      for( unsigned idof = msh->_dofOffset[2][_iproc]; idof < msh->_dofOffset[2][_iproc + 1]; idof++ ) {
+        double distance = 0.;
+        for( unsigned k = 0; k < dim; k++ ) {
+          double dx = (*msh->_topology->_Sol[k])(idof) - _quantities[q].point[k];
+          distance += dx * dx;
+        }
+        if( distance < closest.distance ) {
+          closest.distance = distance;
+          closestDof = idof;
+        }
+      }
+
+      MPI_Allreduce(&closest, &globalClosest, 1, MPI_DOUBLE_INT, MPI_MINLOC, MPI_COMM_WORLD);
+      _quantities[q].probeProc = globalClosest.proc;
+      _quantities[q].probeDof = closestDof;
+    }
+    _probeLevel = level;
+  }
+
+
+  void InSituAnalysis::Evaluate(const double &time, const unsigned &time_step) {
+
+    unsigned level = _ml_sol->_mlMesh->GetNumberOfLevels() - 1u;
+    Mesh *msh = _ml_sol->_mlMesh->GetLevel(level);
+    elem *el = msh->el;
+    Solution *sol = _ml_sol->GetSolutionLevel(level);
+
+    const unsigned dim = msh->GetDimension();
+    const unsigned xType = 2;
+    const unsigned nQuantities = _quantities.size();
+
+    _values.assign(nQuantities, 0.);
+
+    // the variables of the volume integrals, interpolated once in each Gauss point
+    std::vector < unsigned > volumeVariables;
+    std::map < unsigned, unsigned > volumePosition;
+    bool volumeIntegrals = false;
+    bool boundaryIntegrals = false;
+    for( unsigned q = 0; q < nQuantities; q++ ) {
+      if( _quantities[q].kind == VOLUME_INTEGRAL ) {
+        volumeIntegrals = true;
+        for( unsigned i = 0; i < _quantities[q].solIndex.size(); i++ ) {
+          if( volumePosition.find(_quantities[q].solIndex[i]) == volumePosition.end() ) {
+            volumePosition[_quantities[q].solIndex[i]] = volumeVariables.size();
+            volumeVariables.push_back(_quantities[q].solIndex[i]);
+          }
+        }
+      }
+      else if( _quantities[q].kind == BOUNDARY_INTEGRAL ) boundaryIntegrals = true;
+    }
+
+    std::vector < std::vector < double > > x(dim);
+    std::vector < std::vector < double > > solLocal(volumeVariables.size());
+    std::vector < double > solGauss(volumeVariables.size());
+    std::vector < std::vector < double > > gradGauss(volumeVariables.size(), std::vector < double > (dim));
+    std::vector < double > xGauss(dim);
+    std::vector < double > phi, phi_x, phi_xx;
+    std::vector < double > phiX, phiX_x, phiX_xx;
+    double weight, weightVar;
+
+    std::vector < std::vector < double > > xFace(dim);
+    std::vector < double > normal(dim);
+    std::vector < double > solFace;
+    std::vector < std::vector < double > > solFaceLocal;
+
+    std::vector < double > quantitySol;
+    std::vector < std::vector < double > > quantityGrad;
+
+    // element loop: each process loops only on the elements that owns, all the integrals are accumulated together
+    if( volumeIntegrals || boundaryIntegrals ) {
+      for( int iel = msh->_elementOffset[_iproc]; iel < msh->_elementOffset[_iproc + 1]; iel++ ) {
+
+        short unsigned ielGeom = msh->GetElementType(iel);
+        unsigned nDofsX = msh->GetElementDofNumber(iel, xType);
+        for( unsigned k = 0; k < dim; k++ ) x[k].resize(nDofsX);
+        for( unsigned i = 0; i < nDofsX; i++ ) {
+          unsigned xDof = msh->GetSolutionDof(i, iel, xType);
+          for( unsigned k = 0; k < dim; k++ ) {
+            x[k][i] = (*msh->_topology->_Sol[k])(xDof);
+          }
+        }
+
+        // volume integrals
+        bool elementIntegrals = false;
+        for( unsigned q = 0; q < nQuantities; q++ ) {
+          if( _quantities[q].kind == VOLUME_INTEGRAL &&
+              ( _quantities[q].region < 0 || _quantities[q].region == msh->GetElementGroup(iel) ) ) elementIntegrals = true;
+        }
+
+        if( elementIntegrals ) {
+          for( unsigned ivar = 0; ivar < volumeVariables.size(); ivar++ ) {
+            unsigned solType = _ml_sol->GetSolutionType(volumeVariables[ivar]);
+            unsigned nDofs = msh->GetElementDofNumber(iel, solType);
+            solLocal[ivar].resize(nDofs);
+            for( unsigned i = 0; i < nDofs; i++ ) {
+              unsigned solDof = msh->GetSolutionDof(i, iel, solType);
+              solLocal[ivar][i] = (*sol->_Sol[volumeVariables[ivar]])(solDof);
+            }
+          }
+
+          for( unsigned ig = 0; ig < msh->_finiteElement[ielGeom][xType]->GetGaussPointNumber(); ig++ ) {
+            msh->_finiteElement[ielGeom][xType]->Jacobian(x, ig, weight, phiX, phiX_x, phiX_xx);
+            for( unsigned k = 0; k < dim; k++ ) {
+              xGauss[k] = 0.;
+              for( unsigned i = 0; i < nDofsX; i++ ) xGauss[k] += phiX[i] * x[k][i];
+            }
+
+            for( unsigned ivar = 0; ivar < volumeVariables.size(); ivar++ ) {
+              unsigned solType = _ml_sol->GetSolutionType(volumeVariables[ivar]);
+              solGauss[ivar] = 0.;
+              gradGauss[ivar].assign(dim, 0.);
+              if( solType < 3 ) {
+                msh->_finiteElement[ielGeom][solType]->Jacobian(x, ig, weightVar, phi, phi_x, phi_xx);
+                for( unsigned i = 0; i < solLocal[ivar].size(); i++ ) {
+                  solGauss[ivar] += phi[i] * solLocal[ivar][i];
+                  for( unsigned k = 0; k < dim; k++ ) gradGauss[ivar][k] += phi_x[i * dim + k] * solLocal[ivar][i];
+                }
+              }
+              else { // piecewise constant
+                solGauss[ivar] = solLocal[ivar][0];
+              }
+            }
+
+            for( unsigned q = 0; q < nQuantities; q++ ) {
+              if( _quantities[q].kind == VOLUME_INTEGRAL &&
+                  ( _quantities[q].region < 0 || _quantities[q].region == msh->GetElementGroup(iel) ) ) {
+                unsigned nVars = _quantities[q].solIndex.size();
+                quantitySol.resize(nVars);
+                quantityGrad.resize(nVars);
+                for( unsigned i = 0; i < nVars; i++ ) {
+                  unsigned ivar = volumePosition[_quantities[q].solIndex[i]];
+                  quantitySol[i] = solGauss[ivar];
+                  quantityGrad[i] = gradGauss[ivar];
+                }
+                _values[q] += _quantities[q].volumeFunctional(xGauss, quantitySol, quantityGrad, time) * weight;
+              }
+            }
+          }
+        }
+
+        // boundary integrals
+        if( boundaryIntegrals ) {
+          for( unsigned jface = 0; jface < msh->GetElementFaceNumber(iel); jface++ ) {
+            if( el->GetFaceElementIndex(iel, jface) >= 0 ) continue;
+            int faceIndex = el->GetBoundaryIndex(iel, jface);
+            const unsigned felt = msh->GetElementFaceType(iel, jface);
+
+            unsigned nFaceDofsX = msh->GetElementFaceDofNumber(iel, jface, xType);
+            for( unsigned k = 0; k < dim; k++ ) xFace[k].resize(nFaceDofsX);
+            for( unsigned i = 0; i < nFaceDofsX; i++ ) {
+              unsigned ilocal = msh->GetLocalFaceVertexIndex(iel, jface, i);
+              for( unsigned k = 0; k < dim; k++ ) xFace[k][i] = x[k][ilocal];
+            }
+
+            for( unsigned q = 0; q < nQuantities; q++ ) {
+              if( _quantities[q].kind != BOUNDARY_INTEGRAL || _quantities[q].region != faceIndex ) continue;
+
+              unsigned nVars = _quantities[q].solIndex.size();
+              solFaceLocal.resize(nVars);
+              for( unsigned ivar = 0; ivar < nVars; ivar++ ) {
+                unsigned solType = _ml_sol->GetSolutionType(_quantities[q].solIndex[ivar]);
+                unsigned nFaceDofs = msh->GetElementFaceDofNumber(iel, jface, solType);
+                solFaceLocal[ivar].resize(nFaceDofs);
+                for( unsigned i = 0; i < nFaceDofs; i++ ) {
+                  unsigned ilocal = msh->GetLocalFaceVertexIndex(iel, jface, i);
+                  unsigned solDof = msh->GetSolutionDof(ilocal, iel, solType);
+                  solFaceLocal[ivar][i] = (*sol->_Sol[_quantities[q].solIndex[ivar]])(solDof);
+                }
+              }
+
+              solFace.resize(nVars);
+              for( unsigned ig = 0; ig < msh->_finiteElement[felt][xType]->GetGaussPointNumber(); ig++ ) {
+                msh->_finiteElement[felt][xType]->JacobianSur(xFace, ig, weight, phiX, phiX_x, normal);
+                for( unsigned k = 0; k < dim; k++ ) {
+                  xGauss[k] = 0.;
+                  for( unsigned i = 0; i < nFaceDofsX; i++ ) xGauss[k] += phiX[i] * xFace[k][i];
+                }
+                for( unsigned ivar = 0; ivar < nVars; ivar++ ) {
+                  unsigned solType = _ml_sol->GetSolutionType(_quantities[q].solIndex[ivar]);
+                  msh->_finiteElement[felt][solType]->JacobianSur(xFace, ig, weightVar, phi, phi_x, normal);
+                  solFace[ivar] = 0.;
+                  for( unsigned i = 0; i < solFaceLocal[ivar].size(); i++ ) solFace[ivar] += phi[i] * solFaceLocal[ivar][i];
+                }
+                _values[q] += _quantities[q].boundaryFunctional(xGauss, normal, solFace, time) * weight;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // probes: the variables are interpolated on the coordinate nodes, the owner of the node sets the value
+    if( _probeLevel != static_cast < int > (level) ) LocateProbes(level);
+    std::map < unsigned, NumericVector* > probeSolution;
+    for( unsigned q = 0; q < nQuantities; q++ ) {
+      if( _quantities[q].kind != PROBE ) continue;
+      unsigned solIndex = _quantities[q].solIndex[0];
+      if( probeSolution.find(solIndex) == probeSolution.end() ) {
+        NumericVector *projected = msh->_topology->_Sol[0]->clone().release();
+        projected->matrix_mult(*sol->_Sol[solIndex], *msh->GetQitoQjProjection(xType, _ml_sol->GetSolutionType(solIndex)));
+        probeSolution[solIndex] = projected;
+      }
+      if( _quantities[q].probeProc == static_cast < int > (_iproc) ) {
+        _values[q] = (*probeSolution[solIndex])(_quantities[q].probeDof);
+      }
+    }
+    for( std::map < unsigned, NumericVector* >::iterator it = probeSolution.begin(); it != probeSolution.end(); it++ ) {
+      delete it->second;
+    }
+
+    // one reduction for all the quantities
+    if( nQuantities > 0 ) {
+      MPI_Allreduce(MPI_IN_PLACE, &_values[0], nQuantities, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
+
+    // print the time series
+    if( _iproc == 0 && _filename.size() > 0 ) {
+      if( !_fout.is_open() ) {
+        std::ifstream existing(_filename.c_str());
+        bool newFile = !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+        existing.close();
+        _fout.open(_filename.c_str(), std::ios::out | std::ios::app);
+        if( !_fout.is_open() ) {
+          std::cout << std::endl << " The output file " << _filename << " cannot be opened.\n";
+          abort();
+        }
+        if( newFile ) {
+          _fout << "time_step,time";
+          for( unsigned q = 0; q < nQuantities; q++ ) _fout << "," << _quantities[q].name;
+          _fout << std::endl;
+        }
+      }
+      _fout << time_step << "," << std::setprecision(16) << time;
+      for( unsigned q = 0; q < nQuantities; q++ ) _fout << "," << _values[q];
+      _fout << std::endl;
+    }
+  }
+
+
+} //end namespace femus
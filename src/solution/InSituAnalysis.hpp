@@ -0,0 +1,125 @@
+/*=========================================================================
+
+ Program: FEMUS
+ Module: InSituAnalysis
+ Authors: Eugenio Aulisa, Simone Bnà
+
+ Copyright (c) FEMTTU
+ All rights reserved.
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#ifndef __femus_solution_InSituAnalysis_hpp__
+#define __femus_solution_InSituAnalysis_hpp__
+
+//----------------------------------------------------------------------------
+// includes :
+//----------------------------------------------------------------------------
+#include <vector>
+#include <string>
+#include <fstream>
+#include "ParallelObject.hpp"
+
+
+namespace femus {
+
+  //------------------------------------------------------------------------------
+  // Forward declarations
+  //------------------------------------------------------------------------------
+  class MultiLevelSolution;
+
+
+  /**
+   * In-situ analysis of a MultiLevelSolution: volume integrals, boundary integrals and point probes are evaluated
+   * on the finest level with a single element loop and a single reduction, and appended as one line of a CSV time series.
+   **/
+  class InSituAnalysis : public ParallelObject {
+
+  public:
+
+    /** Volume integrand: coordinates, values and gradients (one vector for each variable) in the Gauss point */
+    typedef double (*VolumeFunctional) (const std::vector < double > &x, const std::vector < double > &solution,
+                                        const std::vector < std::vector < double > > &gradient, const double &time);
+
+    /** Boundary integrand: coordinates, outward normal and values of the variables in the Gauss point */
+    typedef double (*BoundaryFunctional) (const std::vector < double > &x, const std::vector < double > &normal,
+                                          const std::vector < double > &solution, const double &time);
+
+    /** Constructor */
+    InSituAnalysis(MultiLevelSolution *ml_sol);
+
+    /** Destructor */
+    ~InSituAnalysis();
+
+    /** Add the integral of functional over the elements of the given group (-1 = all the elements) */
+    void AddVolumeIntegral(const std::string &name, const std::vector < std::string > &variables,
+                           VolumeFunctional functional, const int &group = -1);
+
+    /** Add the integral of functional over the boundary faces with the given boundary index */
+    void AddBoundaryIntegral(const std::string &name, const std::vector < std::string > &variables,
+                             BoundaryFunctional functional, const int &faceIndex);
+
+    /** Add the history of the Lagrangian variable in the node closest to the point x */
+    void AddProbe(const std::string &name, const std::string &variable, const std::vector < double > &x);
+
+    /** Append the quantities to the CSV file filename, one line for each evaluation (printed by process 0) */
+    void SetOutputFile(const std::string &filename);
+
+    /** Evaluate all the quantities and append them to the output file */
+    void Evaluate(const double &time = 0., const unsigned &time_step = 0);
+
+    /** The values of the last evaluation, in the order in which the quantities have been added */
+    const std::vector < double >& GetValues() const {
+      return _values;
+    };
+
+    /** The value of the quantity name in the last evaluation */
+    double GetValue(const std::string &name) const;
+
+  private:
+
+    enum QuantityKind { VOLUME_INTEGRAL, BOUNDARY_INTEGRAL, PROBE };
+
+    struct AnalysisQuantity {
+      std::string name;
+      QuantityKind kind;
+      std::vector < unsigned > solIndex;
+      VolumeFunctional volumeFunctional;
+      BoundaryFunctional boundaryFunctional;
+      /** element group or boundary index */
+      int region;
+      std::vector < double > point;
+      /** the process that owns the probe node and the node itself */
+      int probeProc;
+      unsigned probeDof;
+    };
+
+    /** The solution variables of a quantity */
+    std::vector < unsigned > GetVariableIndices(const std::vector < std::string > &variables, const bool &lagrangeOnly) const;
+
+    /** Find the node closest to each probe on the level */
+    void LocateProbes(const unsigned &level);
+
+    MultiLevelSolution *_ml_sol;
+
+    std::vector < AnalysisQuantity > _quantities;
+
+    std::vector < double > _values;
+
+    /** the level on which the probes have been located, -1 before the first evaluation */
+    int _probeLevel;
+
+    std::string _filename;
+    std::ofstream _fout;
+
+  };
+
+} //end namespace femus
+
+
+
+#endif
@@ -17,6 +17,7 @@ PURPOSE.  See the above copyright notice for more information.
 // includes :
 //----------------------------------------------------------------------------
 #include "MultiLevelSolution.hpp"
+#include "InSituAnalysis.hpp"
 #include "ElemType.hpp"
 #include "SparseMatrix.hpp"
 #include "NumericVector.hpp"
@@ -30,6 +31,11 @@ PURPOSE.  See the above copyright notice for more information.
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include "mpi.h"
 
 namespace femus {
 
@@ -48,6 +54,7 @@ MultiLevelSolution::~MultiLevelSolution() {
   for (unsigned i=0; i<_solName.size(); i++) delete [] _solName[i];
   for (unsigned i=0; i<_solName.size(); i++) delete [] _bdcType[i];
 
+  delete _inSituAnalysis;
 
 };
 
@@ -68,6 +75,13 @@ MultiLevelSolution::MultiLevelSolution( MultiLevelMesh *ml_msh):
 
   _mlBCProblem = NULL;
 
+  _inSituAnalysis = NULL;
+
+}
+
+InSituAnalysis* MultiLevelSolution::GetInSituAnalysis() {
+  if( _inSituAnalysis == NULL ) _inSituAnalysis = new InSituAnalysis(this);
+  return _inSituAnalysis;
 }
 
 void MultiLevelSolution::AddSolutionLevel(){
@@ -554,4 +568,377 @@ void MultiLevelSolution::GenerateBdc(const unsigned int k, const unsigned int gr
 
 }
 
+//---------------------------------------------------------------------------------------------------
+// parallel checkpoint
+//---------------------------------------------------------------------------------------------------
+
+/** Partition independent key of a dof: its quantized coordinates (element centroid for the discontinuous
+ * solutions) and its local index in the element */
+struct CheckpointKey {
+  long long x[4];
+  bool operator< (const CheckpointKey &key) const {
+    for(unsigned k = 0; k < 4; k++) {
+      if(x[k] != key.x[k]) return x[k] < key.x[k];
+    }
+    return false;
+  }
+};
+
+struct LocalCheckpointKey {
+  CheckpointKey key;
+  unsigned dof;
+  bool operator< (const LocalCheckpointKey &b) const {
+    return key < b.key;
+  }
+};
+
+/** A key of the checkpoint, sent to the process that matches it: rank and index are the owner and the dof
+ * for the keys of the current partition, the reader and the position in its slab for the keys of the file */
+struct CheckpointRecord {
+  CheckpointKey key;
+  int rank;
+  unsigned index;
+  bool operator< (const CheckpointRecord &b) const {
+    return key < b.key;
+  }
+};
+
+/** A matched key of the file: its position in the slab of the reader, and the owner and the dof in the current partition */
+struct CheckpointMatch {
+  unsigned index;
+  int rank;
+  unsigned dof;
+};
+
+static const char _checkpointMagic[8] = {'F', 'E', 'M', 'U', 'S', 'C', 'P', '\0'};
+static const unsigned _checkpointVersion = 1;
+static const unsigned _checkpointNameSize = 64;
+static const long long _checkpointCellBlock = 1024;
+
+template <class T>
+static void AppendToBuffer(std::vector < char > &buffer, const T &value) {
+  const char *pt = reinterpret_cast < const char* > (&value);
+  buffer.insert(buffer.end(), pt, pt + sizeof(T));
+}
+
+template <class T>
+static void ReadFromBuffer(const std::vector < char > &buffer, unsigned &position, T &value) {
+  memcpy(&value, &buffer[position], sizeof(T));
+  position += sizeof(T);
+}
+
+/** Shift the coordinates of the key to the k-th of the 27 neighboring quantization cells */
+static void ShiftCheckpointKey(CheckpointKey &key, const unsigned &k) {
+  unsigned shift[3] = {k % 3, (k / 3) % 3, k / 9}; // 0, +1, -1
+  for(unsigned d = 0; d < 3; d++) key.x[d] += (shift[d] == 2) ? -1 : static_cast < int >(shift[d]);
+}
+
+/** The process that matches the keys of a block of quantization cells: the blocks are hashed over the processes */
+static int GetCheckpointKeyHome(const CheckpointKey &key, const int &nprocs) {
+  unsigned long long hash = static_cast < unsigned long long >(key.x[3]);
+  for(unsigned d = 0; d < 3; d++) {
+    long long block = (key.x[d] >= 0) ? key.x[d] / _checkpointCellBlock : -((-key.x[d] - 1) / _checkpointCellBlock) - 1;
+    hash = hash * 1000003ull ^ static_cast < unsigned long long >(block);
+  }
+  return static_cast < int >(hash % nprocs);
+}
+
+/** Send to every process its bucket with MPI_Alltoallv, and gather the received items in recv ordered by sender */
+template <class T>
+static void ExchangeCheckpointBuckets(const std::vector < std::vector < T > > &send, std::vector < T > &recv) {
+
+  int nprocs = send.size();
+  MPI_Datatype type;
+  MPI_Type_contiguous(sizeof(T), MPI_BYTE, &type);
+  MPI_Type_commit(&type);
+
+  std::vector < int > sendCount(nprocs), sendDispl(nprocs), recvCount(nprocs), recvDispl(nprocs);
+  unsigned sendSize = 0;
+  for(int i = 0; i < nprocs; i++) {
+    sendCount[i] = send[i].size();
+    sendDispl[i] = sendSize;
+    sendSize += send[i].size();
+  }
+  MPI_Alltoall(&sendCount[0], 1, MPI_INT, &recvCount[0], 1, MPI_INT, MPI_COMM_WORLD);
+  unsigned recvSize = 0;
+  for(int i = 0; i < nprocs; i++) {
+    recvDispl[i] = recvSize;
+    recvSize += recvCount[i];
+  }
+
+  std::vector < T > sendBuffer(sendSize + 1u);
+  for(int i = 0; i < nprocs; i++) std::copy(send[i].begin(), send[i].end(), sendBuffer.begin() + sendDispl[i]);
+  recv.resize(recvSize + 1u);
+  MPI_Alltoallv(&sendBuffer[0], &sendCount[0], &sendDispl[0], type, &recv[0], &recvCount[0], &recvDispl[0], type, MPI_COMM_WORLD);
+  recv.resize(recvSize);
+
+  MPI_Type_free(&type);
+}
+
+/** Build the keys of the dofs of type solType owned by this process, in the mesh numbering */
+static void BuildCheckpointKeys(Mesh *msh, const unsigned &solType, const double &h, const int &iproc, std::vector < LocalCheckpointKey > &keys) {
+
+  unsigned dofStart = msh->_dofOffset[solType][iproc];
+  unsigned ownSize = msh->_ownSize[solType][iproc];
+  keys.resize(ownSize);
+  std::vector < bool > found(ownSize, false);
+
+  for(unsigned iel = msh->_elementOffset[iproc]; iel < msh->_elementOffset[iproc + 1]; iel++) {
+    double centroid[3] = {0., 0., 0.};
+    if(solType >= 3) {
+      unsigned nVertices = msh->GetElementDofNumber(iel, 0);
+      for(unsigned i = 0; i < nVertices; i++) {
+        unsigned xDof = msh->GetSolutionDof(i, iel, 2);
+        for(unsigned d = 0; d < 3; d++) centroid[d] += (*msh->_topology->_Sol[d])(xDof) / nVertices;
+      }
+    }
+    for(unsigned j = 0; j < msh->GetElementDofNumber(iel, solType); j++) {
+      unsigned dof = msh->GetSolutionDof(j, iel, solType);
+      if(dof < dofStart || dof >= dofStart + ownSize || found[dof - dofStart]) continue;
+      found[dof - dofStart] = true;
+      LocalCheckpointKey &local = keys[dof - dofStart];
+      local.dof = dof;
+      for(unsigned d = 0; d < 3; d++) {
+        double x = (solType < 3) ? (*msh->_topology->_Sol[d])(msh->GetSolutionDof(j, iel, 2)) : centroid[d];
+        local.key.x[d] = static_cast < long long >(floor(x / h + 0.5));
+      }
+      local.key.x[3] = (solType < 3) ? 0 : j;
+    }
+  }
+}
+
+/** The header of the checkpoint file */
+void MultiLevelSolution::BuildCheckpointHeader(std::vector < char > &header, const double &time, const unsigned &time_step, const double &h) const {
+  header.assign(_checkpointMagic, _checkpointMagic + 8);
+  AppendToBuffer(header, _checkpointVersion);
+  AppendToBuffer(header, static_cast < unsigned >(_gridn));
+  AppendToBuffer(header, static_cast < unsigned >(_solName.size()));
+  AppendToBuffer(header, time);
+  AppendToBuffer(header, time_step);
+  AppendToBuffer(header, h);
+  for(unsigned i = 0; i < _solName.size(); i++) {
+    char name[_checkpointNameSize];
+    memset(name, 0, _checkpointNameSize);
+    strncpy(name, _solName[i], _checkpointNameSize - 1);
+    header.insert(header.end(), name, name + _checkpointNameSize);
+    AppendToBuffer(header, _solType[i]);
+    AppendToBuffer(header, static_cast < unsigned >(_solTimeOrder[i] == 2));
+  }
+}
+
+void MultiLevelSolution::SaveCheckpoint(const std::string &filename, const double &time, const unsigned &time_step) {
+
+  // the quantization step of the coordinates in the keys
+  double h = 0.;
+  for(unsigned d = 0; d < 3; d++) {
+    double norm = _mlMesh->GetLevel(_gridn - 1u)->_topology->_Sol[d]->linfty_norm();
+    h = (h > norm) ? h : norm;
+  }
+  h = ((h > 0.) ? h : 1.) * 1.0e-10;
+
+  std::vector < char > header;
+  BuildCheckpointHeader(header, time, time_step, h);
+
+  // the checkpoint is written on a temporary file, that replaces the previous one only when complete
+  std::string tmpFilename = filename + ".tmp";
+  MPI_File fh;
+  if(MPI_File_open(MPI_COMM_WORLD, const_cast < char* >(tmpFilename.c_str()), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                   MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+    std::cout << "Error: the checkpoint file " << tmpFilename << " cannot be opened" << std::endl;
+    abort();
+  }
+  MPI_File_set_size(fh, 0);
+  if(_iproc == 0) MPI_File_write_at(fh, 0, &header[0], header.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+
+  MPI_Offset sectionOffset = header.size();
+  std::vector < LocalCheckpointKey > keys;
+  std::vector < CheckpointKey > fileKeys;
+  std::vector < double > values;
+
+  for(unsigned ig = 0; ig < _gridn; ig++) {
+    Mesh *msh = _mlMesh->GetLevel(ig);
+    for(unsigned solType = 0; solType < 5; solType++) {
+      if(std::find(_solType.begin(), _solType.end(), static_cast < int >(solType)) == _solType.end()) continue;
+
+      MPI_Offset nDofs = msh->_dofOffset[solType][_nprocs];
+      MPI_Offset dofStart = msh->_dofOffset[solType][_iproc];
+      unsigned ownSize = msh->_ownSize[solType][_iproc];
+
+      // keys, in the order of the global dofs of this partition
+      BuildCheckpointKeys(msh, solType, h, _iproc, keys);
+      fileKeys.resize(ownSize + 1u);
+      for(unsigned i = 0; i < ownSize; i++) fileKeys[i] = keys[i].key;
+      MPI_File_write_at_all(fh, sectionOffset + dofStart * sizeof(CheckpointKey), &fileKeys[0], ownSize * sizeof(CheckpointKey),
+                            MPI_BYTE, MPI_STATUS_IGNORE);
+      sectionOffset += nDofs * sizeof(CheckpointKey);
+
+      // values of the current and old solutions of this type
+      values.resize(ownSize + 1u);
+      for(unsigned i = 0; i < _solName.size(); i++) {
+        if(_solType[i] != static_cast < int >(solType)) continue;
+        for(unsigned old = 0; old < 1u + (_solTimeOrder[i] == 2); old++) {
+          NumericVector *sol = (old == 0) ? _solution[ig]->_Sol[i] : _solution[ig]->_SolOld[i];
+          for(unsigned j = 0; j < ownSize; j++) values[j] = (*sol)(dofStart + j);
+          MPI_File_write_at_all(fh, sectionOffset + dofStart * sizeof(double), &values[0], ownSize, MPI_DOUBLE, MPI_STATUS_IGNORE);
+          sectionOffset += nDofs * sizeof(double);
+        }
+      }
+    }
+  }
+  MPI_File_close(&fh);
+
+  if(_iproc == 0) {
+    if(std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+      std::cout << "Error: the checkpoint file " << filename << " cannot be written" << std::endl;
+      abort();
+    }
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+void MultiLevelSolution::LoadCheckpoint(const std::string &filename, double &time, unsigned &time_step) {
+
+  MPI_File fh;
+  if(MPI_File_open(MPI_COMM_WORLD, const_cast < char* >(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+    std::cout << "Error: the checkpoint file " << filename << " cannot be opened" << std::endl;
+    abort();
+  }
+
+  // read and check the header against the solutions of this MultiLevelSolution
+  unsigned headerSize = 8 + 3 * sizeof(unsigned) + 2 * sizeof(double) + sizeof(unsigned) +
+                        _solName.size() * (_checkpointNameSize + sizeof(int) + sizeof(unsigned));
+  std::vector < char > fileHeader(headerSize);
+  MPI_File_read_at_all(fh, 0, &fileHeader[0], headerSize, MPI_BYTE, MPI_STATUS_IGNORE);
+
+  unsigned position = 8;
+  unsigned version, gridn, nSolutions;
+  double h;
+  ReadFromBuffer(fileHeader, position, version);
+  ReadFromBuffer(fileHeader, position, gridn);
+  ReadFromBuffer(fileHeader, position, nSolutions);
+  ReadFromBuffer(fileHeader, position, time);
+  ReadFromBuffer(fileHeader, position, time_step);
+  ReadFromBuffer(fileHeader, position, h);
+
+  std::vector < char > header;
+  BuildCheckpointHeader(header, time, time_step, h);
+  if(memcmp(&fileHeader[0], _checkpointMagic, 8) != 0 || version != _checkpointVersion || header != fileHeader) {
+    std::cout << "Error: the checkpoint file " << filename << " does not match the levels and the solutions of the problem" << std::endl;
+    abort();
+  }
+
+  MPI_Datatype keyType;
+  MPI_Type_contiguous(sizeof(CheckpointKey), MPI_BYTE, &keyType);
+  MPI_Type_commit(&keyType);
+
+  MPI_Offset sectionOffset = headerSize;
+  std::vector < LocalCheckpointKey > keys;
+  std::vector < CheckpointKey > fileKeys;
+  std::vector < double > values;
+  std::vector < std::vector < CheckpointRecord > > sendRecords(_nprocs);
+  std::vector < CheckpointRecord > ownerRecords;
+  std::vector < CheckpointRecord > fileRecords;
+  std::vector < std::vector < CheckpointMatch > > sendMatches(_nprocs);
+  std::vector < CheckpointMatch > matches;
+  std::vector < std::vector < unsigned > > slabIndex(_nprocs);
+  std::vector < std::vector < unsigned > > sendDofs(_nprocs);
+  std::vector < unsigned > localDof;
+  std::vector < std::vector < double > > sendValues(_nprocs);
+  std::vector < double > localValues;
+  std::vector < int > homes;
+
+  for(unsigned ig = 0; ig < _gridn; ig++) {
+    Mesh *msh = _mlMesh->GetLevel(ig);
+    for(unsigned solType = 0; solType < 5; solType++) {
+      if(std::find(_solType.begin(), _solType.end(), static_cast < int >(solType)) == _solType.end()) continue;
+
+      MPI_Offset nDofs = msh->_dofOffset[solType][_nprocs];
+      unsigned ownSize = msh->_ownSize[solType][_iproc];
+
+      // every process reads a slab of the section, independently of the old and of the current partitions
+      MPI_Offset slabStart = (nDofs * _iproc) / _nprocs;
+      unsigned slabSize = (nDofs * (_iproc + 1)) / _nprocs - slabStart;
+      fileKeys.resize(slabSize + 1u);
+      MPI_File_read_at_all(fh, sectionOffset + slabStart * sizeof(CheckpointKey), &fileKeys[0], slabSize, keyType, MPI_STATUS_IGNORE);
+      sectionOffset += nDofs * sizeof(CheckpointKey);
+
+      // the keys of the dofs owned by this process and the keys of the slab meet on the process of their block of cells;
+      // the keys of the slab may differ by round-off: they go also to the blocks of the neighboring quantization cells
+      BuildCheckpointKeys(msh, solType, h, _iproc, keys);
+      for(int jproc = 0; jproc < _nprocs; jproc++) sendRecords[jproc].resize(0);
+      for(unsigned i = 0; i < ownSize; i++) {
+        CheckpointRecord record = {keys[i].key, _iproc, keys[i].dof};
+        sendRecords[GetCheckpointKeyHome(record.key, _nprocs)].push_back(record);
+      }
+      ExchangeCheckpointBuckets(sendRecords, ownerRecords);
+      std::sort(ownerRecords.begin(), ownerRecords.end());
+
+      for(int jproc = 0; jproc < _nprocs; jproc++) sendRecords[jproc].resize(0);
+      for(unsigned i = 0; i < slabSize; i++) {
+        homes.resize(0);
+        for(unsigned k = 0; k < 27; k++) {
+          CheckpointKey key = fileKeys[i];
+          ShiftCheckpointKey(key, k);
+          int home = GetCheckpointKeyHome(key, _nprocs);
+          if(std::find(homes.begin(), homes.end(), home) == homes.end()) homes.push_back(home);
+        }
+        CheckpointRecord record = {fileKeys[i], _iproc, i};
+        for(unsigned j = 0; j < homes.size(); j++) sendRecords[homes[j]].push_back(record);
+      }
+      ExchangeCheckpointBuckets(sendRecords, fileRecords);
+
+      // match the keys, and send the owner and the dof of every matched key back to the process that read it
+      for(int jproc = 0; jproc < _nprocs; jproc++) sendMatches[jproc].resize(0);
+      for(unsigned i = 0; i < fileRecords.size(); i++) {
+        for(unsigned k = 0; k < 27; k++) {
+          CheckpointRecord search = fileRecords[i];
+          ShiftCheckpointKey(search.key, k);
+          std::vector < CheckpointRecord >::iterator it = std::lower_bound(ownerRecords.begin(), ownerRecords.end(), search);
+          if(it != ownerRecords.end() && !(search.key < it->key)) {
+            CheckpointMatch match = {fileRecords[i].index, it->rank, it->index};
+            sendMatches[fileRecords[i].rank].push_back(match);
+            break;
+          }
+        }
+      }
+      ExchangeCheckpointBuckets(sendMatches, matches);
+
+      // send the dofs to their owners, once for all the solutions of this type
+      for(int jproc = 0; jproc < _nprocs; jproc++) {
+        slabIndex[jproc].resize(0);
+        sendDofs[jproc].resize(0);
+      }
+      for(unsigned i = 0; i < matches.size(); i++) {
+        slabIndex[matches[i].rank].push_back(matches[i].index);
+        sendDofs[matches[i].rank].push_back(matches[i].dof);
+      }
+      ExchangeCheckpointBuckets(sendDofs, localDof);
+      if(localDof.size() != ownSize) {
+        std::cout << "Error: the checkpoint file " << filename << " does not match the mesh at level " << ig << std::endl;
+        abort();
+      }
+
+      // redistribute the values of the current and old solutions of this type, in the same order as the dofs
+      values.resize(slabSize + 1u);
+      for(unsigned i = 0; i < _solName.size(); i++) {
+        if(_solType[i] != static_cast < int >(solType)) continue;
+        for(unsigned old = 0; old < 1u + (_solTimeOrder[i] == 2); old++) {
+          NumericVector *sol = (old == 0) ? _solution[ig]->_Sol[i] : _solution[ig]->_SolOld[i];
+          MPI_File_read_at_all(fh, sectionOffset + slabStart * sizeof(double), &values[0], slabSize, MPI_DOUBLE, MPI_STATUS_IGNORE);
+          for(int jproc = 0; jproc < _nprocs; jproc++) {
+            sendValues[jproc].resize(slabIndex[jproc].size());
+            for(unsigned j = 0; j < slabIndex[jproc].size(); j++) sendValues[jproc][j] = values[slabIndex[jproc][j]];
+          }
+          ExchangeCheckpointBuckets(sendValues, localValues);
+          for(unsigned j = 0; j < localDof.size(); j++) sol->set(localDof[j], localValues[j]);
+          sol->close();
+          sectionOffset += nDofs * sizeof(double);
+        }
+      }
+    }
+  }
+  MPI_Type_free(&keyType);
+  MPI_File_close(&fh);
+}
+
 } //end namespace femus
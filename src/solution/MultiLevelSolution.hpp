@@ -33,6 +33,7 @@ namespace femus {
 
 
 class MultiLevelProblem;
+class InSituAnalysis;
 
 /**
  * This class is a black box container to handle multilevel solutions.
@@ -123,6 +124,13 @@ public:
     /** To be Added */
     void UpdateBdc(const double time);
 
+    /** Write the current and old solutions of all the levels, with time and time step, in a single file with parallel MPI-IO.
+     * The dofs are keyed by their coordinates, so that the checkpoint can be read back on a different number of processes */
+    void SaveCheckpoint(const std::string &filename, const double &time = 0., const unsigned &time_step = 0);
+
+    /** Read the checkpoint written by SaveCheckpoint, redistributing the dofs over the current partition */
+    void LoadCheckpoint(const std::string &filename, double &time, unsigned &time_step);
+
     /** To be Added */
     void GenerateBdc( const unsigned int k, const unsigned grid0, const double time );
 
@@ -188,6 +196,9 @@ public:
     /** To be Added */
     void SetWriter(const WriterEnum format) { _writer = Writer::build(format,this).release(); }
 
+    /** The in-situ analysis (integrals and probes) of this solution, built at the first call */
+    InSituAnalysis* GetInSituAnalysis();
+
     // member data
     MultiLevelMesh* _mlMesh; //< Multilevel mesh
 
@@ -215,6 +226,9 @@ private:
     /** To be Added */
     bool Ishomogeneous(const unsigned int var, const unsigned int facename) const;
 
+    /** The checkpoint header: levels, time, quantization step of the keys and the solution names, types and time orders */
+    void BuildCheckpointHeader(std::vector < char > &header, const double &time, const unsigned &time_step, const double &h) const;
+
     /** To be Added */
     FunctionBase* GetBdcFunction(const unsigned int var, const unsigned int facename) const;
 
@@ -245,6 +259,9 @@ private:
     /** Multilevel solution writer */
     Writer* _writer;
 
+    /** in-situ analysis, NULL until it is requested */
+    InSituAnalysis* _inSituAnalysis;
+
     const MultiLevelProblem* _mlBCProblem;
 
 };
@@ -0,0 +1,104 @@
+/*=========================================================================
+
+ Program: FEMUS
+ Module: OutputQueue
+ Authors: Eugenio Aulisa, Simone Bnà
+
+ Copyright (c) FEMTTU
+ All rights reserved.
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+//----------------------------------------------------------------------------
+// includes :
+//----------------------------------------------------------------------------
+#include "OutputQueue.hpp"
+#include <iostream>
+#include <cstdlib>
+
+
+namespace femus {
+
+  const unsigned OutputQueue::_maxBlockSize = 1u << 30;
+
+  OutputQueue::OutputQueue(const unsigned &maxPendingWrites) {
+    _maxPendingWrites = ( maxPendingWrites > 0 ) ? maxPendingWrites : 1;
+  }
+
+  OutputQueue::~OutputQueue() {
+    Flush();
+  }
+
+  void OutputQueue::SetMaxPendingWrites(const unsigned &maxPendingWrites) {
+    _maxPendingWrites = ( maxPendingWrites > 0 ) ? maxPendingWrites : 1;
+    while( _pendingWrites.size() > _maxPendingWrites ) WaitOldest();
+  }
+
+  void OutputQueue::Push(const std::string &filename, std::string &buffer) {
+
+    Progress();
+    // a file still being written cannot be opened again
+    for( unsigned i = 0; i < _pendingWrites.size(); i++ ) {
+      if( _pendingWrites[i]->filename == filename ) {
+        Flush();
+        break;
+      }
+    }
+    // back-pressure: the computation waits only when all the staging buffers are busy
+    while( _pendingWrites.size() >= _maxPendingWrites ) WaitOldest();
+
+    PendingWrite *pendingWrite = new PendingWrite;
+    pendingWrite->filename = filename;
+    pendingWrite->data.swap(buffer);
+
+    int error = MPI_File_open(MPI_COMM_SELF, const_cast < char* > (filename.c_str()), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                              MPI_INFO_NULL, &pendingWrite->file);
+    if( error != MPI_SUCCESS ) {
+      std::cout << std::endl << " The output file "<< filename <<" cannot be opened.\n";
+      abort();
+    }
+    MPI_File_set_size(pendingWrite->file, 0);
+
+    // the staged files can exceed 4 GB
+    MPI_Offset size = pendingWrite->data.size();
+    for( MPI_Offset offset = 0; offset < size; offset += _maxBlockSize ) {
+      int blockSize = ( size - offset < _maxBlockSize ) ? size - offset : _maxBlockSize;
+      MPI_Request request;
+      MPI_File_iwrite_at(pendingWrite->file, offset, &pendingWrite->data[offset], blockSize, MPI_CHAR, &request);
+      pendingWrite->requests.push_back(request);
+    }
+
+    _pendingWrites.push_back(pendingWrite);
+  }
+
+  void OutputQueue::Progress() {
+    while( !_pendingWrites.empty() ) {
+      PendingWrite *pendingWrite = _pendingWrites.front();
+      int completed = 1;
+      if( pendingWrite->requests.size() > 0 ) {
+        MPI_Testall(pendingWrite->requests.size(), &pendingWrite->requests[0], &completed, MPI_STATUSES_IGNORE);
+      }
+      if( !completed ) break;
+      WaitOldest();
+    }
+  }
+
+  void OutputQueue::Flush() {
+    while( !_pendingWrites.empty() ) WaitOldest();
+  }
+
+  void OutputQueue::WaitOldest() {
+    PendingWrite *pendingWrite = _pendingWrites.front();
+    _pendingWrites.pop_front();
+    if( pendingWrite->requests.size() > 0 ) {
+      MPI_Waitall(pendingWrite->requests.size(), &pendingWrite->requests[0], MPI_STATUSES_IGNORE);
+    }
+    MPI_File_close(&pendingWrite->file);
+    delete pendingWrite;
+  }
+
+} //end namespace femus
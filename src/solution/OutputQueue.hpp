@@ -0,0 +1,83 @@
+/*=========================================================================
+
+ Program: FEMUS
+ Module: OutputQueue
+ Authors: Eugenio Aulisa, Simone Bnà
+
+ Copyright (c) FEMTTU
+ All rights reserved.
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#ifndef __femus_solution_OutputQueue_hpp__
+#define __femus_solution_OutputQueue_hpp__
+
+//----------------------------------------------------------------------------
+// includes :
+//----------------------------------------------------------------------------
+#include <deque>
+#include <string>
+#include <vector>
+#include "mpi.h"
+
+
+namespace femus {
+
+  /**
+   * Bounded queue of non-blocking file writes. The content of each output file is staged in memory and written with
+   * MPI-IO non-blocking calls, so that the computation goes on while the file is written. When the queue is full
+   * the oldest write is completed before a new one is started.
+   * Only the file write is deferred: the staging (encoding, compression) of the file is still done by the writer
+   * in the time loop, and MPI-IO implementations without asynchronous progress (e.g. ROMIO) may complete the
+   * write within the non-blocking call itself.
+   **/
+  class OutputQueue {
+
+  public:
+
+    /** Constructor */
+    OutputQueue(const unsigned &maxPendingWrites = 2);
+
+    /** Destructor: completes all the pending writes */
+    ~OutputQueue();
+
+    /** Set the maximum number of writes in progress at the same time */
+    void SetMaxPendingWrites(const unsigned &maxPendingWrites);
+
+    /** Take the content of buffer (buffer is left empty) and start writing it to filename */
+    void Push(const std::string &filename, std::string &buffer);
+
+    /** Close the files whose writes have been completed, without waiting for the others */
+    void Progress();
+
+    /** Complete all the pending writes */
+    void Flush();
+
+  private:
+
+    struct PendingWrite {
+      std::string filename;
+      std::string data;
+      MPI_File file;
+      std::vector < MPI_Request > requests;
+    };
+
+    /** Wait for the oldest pending write and close its file */
+    void WaitOldest();
+
+    std::deque < PendingWrite* > _pendingWrites;
+    unsigned _maxPendingWrites;
+
+    /** the largest block passed to a single MPI write call */
+    static const unsigned _maxBlockSize;
+  };
+
+} //end namespace femus
+
+
+
+#endif
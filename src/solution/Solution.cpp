@@ -360,6 +360,30 @@ void Solution::UpdateRes(const vector <unsigned> &_SolPdeIndex, NumericVector* _
 
 }
 
+/**
+ * Compute the l2-norms of _Res (or _Eps) for all the variables with a single reduction
+ **/
+//--------------------------------------------------------------------------------
+void Solution::GetResL2Norms(const vector <unsigned> &_SolPdeIndex, vector <double> &L2norms) {
+
+  vector <NumericVector*> vecs(_SolPdeIndex.size());
+  for (unsigned k=0; k<_SolPdeIndex.size(); k++) {
+    vecs[k] = _Res[_SolPdeIndex[k]];
+  }
+  NumericVector::l2_norms(vecs, L2norms);
+
+}
+
+void Solution::GetEpsL2Norms(const vector <unsigned> &_SolPdeIndex, vector <double> &L2norms) {
+
+  vector <NumericVector*> vecs(_SolPdeIndex.size());
+  for (unsigned k=0; k<_SolPdeIndex.size(); k++) {
+    vecs[k] = _Eps[_SolPdeIndex[k]];
+  }
+  NumericVector::l2_norms(vecs, L2norms);
+
+}
+
 bool Solution::FlagAMRRegionBasedOnl2(const vector <unsigned> &SolIndex,const double &AMRthreshold){
 
   vector <double> SolMax(SolIndex.size());
@@ -83,6 +83,12 @@ public:
         return *_Sol[GetIndex(var)];
     };
 
+    /** Compute the l2-norms of the residuals of the variables _SolPdeIndex with a single global reduction */
+    void GetResL2Norms(const vector <unsigned> &_SolPdeIndex, vector <double> &L2norms);
+
+    /** Compute the l2-norms of the epsilons of the variables _SolPdeIndex with a single global reduction */
+    void GetEpsL2Norms(const vector <unsigned> &_SolPdeIndex, vector <double> &L2norms);
+
      /** Flag the elemets to be refined in the AMR alghorithm based on the epsilon*/
     bool FlagAMRRegionBasedOnl2(const vector <unsigned> &_SolPdeIndex, const double &AMRthreshold);
 
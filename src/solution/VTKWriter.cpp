@@ -19,7 +19,11 @@
 #include "VTKWriter.hpp"
 #include "MultiLevelProblem.hpp"
 #include "NumericVector.hpp"
+#include "FemusConfig.hpp"
 #include <b64/b64.h>
+#ifdef HAVE_ZLIB
+  #include <zlib.h>
+#endif
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -28,6 +32,7 @@
 #include <iomanip>
 #include <algorithm>
 #include "Files.hpp"
+#include "OutputQueue.hpp"
 
 namespace femus {
 
@@ -35,17 +40,125 @@ namespace femus {
  short unsigned int VTKWriter::femusToVtkCellType[3][6]= {{12,10,13,9,5,3},{25,24,26,23,22,21},{29,24,32,28,22,21}};
 
 
-VTKWriter::VTKWriter(MultiLevelSolution * ml_sol): Writer(ml_sol) {}
+  /** Move the node values of the output region to their compacted positions, nodeIndex[i] <= i */
+  static void CompactNodeValues(float *values, const std::vector < int > &nodeIndex, const unsigned &nComponents) {
+    for( unsigned i = 0; i < nodeIndex.size(); i++ ) {
+      if( nodeIndex[i] >= 0 ) {
+        for( unsigned k = 0; k < nComponents; k++ ) {
+          values[ nodeIndex[i] * nComponents + k ] = values[ i * nComponents + k ];
+        }
+      }
+    }
+  }
+
 
-VTKWriter::VTKWriter(MultiLevelMesh * ml_mesh): Writer(ml_mesh) {}
+VTKWriter::VTKWriter(MultiLevelSolution * ml_sol): Writer(ml_sol) {
+  _appended = false;
+  _compressed = false;
+}
+
+VTKWriter::VTKWriter(MultiLevelMesh * ml_mesh): Writer(ml_mesh) {
+  _appended = false;
+  _compressed = false;
+}
 
 VTKWriter::~VTKWriter() {}
 
 
+void VTKWriter::SetCompressedOutput(bool value) {
+#ifdef HAVE_ZLIB
+  _compressed = value;
+#else
+  if( value ) std::cout<<"Warning the VTK writer has been built without zlib, the output is not compressed"<<std::endl;
+  _compressed = false;
+#endif
+}
+
+
+std::string VTKWriter::Compressor() const {
+  return ( _compressed ) ? " compressor=\"vtkZLibDataCompressor\"" : "";
+}
+
+
+std::string VTKWriter::DataArrayFormat() const {
+  std::ostringstream format;
+  if( _appended ) format << "format=\"appended\" offset=\"" << _appendedData.size() << "\"";
+  else format << "format=\"binary\"";
+  return format.str();
+}
+
+
+void VTKWriter::PrintBase64(std::ostream &fout, const void *data, const unsigned &size) {
+  size_t cch = b64::b64_encode(data, size, NULL, 0);
+  if( _encodingBuffer.size() < cch ) _encodingBuffer.resize(cch);
+  b64::b64_encode(data, size, &_encodingBuffer[0], cch);
+  fout.write(&_encodingBuffer[0], cch);
+}
+
+
+/**
+ * Print a DataArray with the VTK UInt32 header: the byte size of the data or, if compressed,
+ * the number of blocks, the block size, the last block size and the compressed size of each block
+ **/
+void VTKWriter::PrintDataArray(std::ostream &fout, const void *data, const unsigned &size) {
+
+  const char *pt_data = static_cast < const char* > (data);
+
+  _header.resize(1);
+  _header[0] = size;
+  unsigned compressedSize = size;
+
+#ifdef HAVE_ZLIB
+  if( _compressed ) {
+    const unsigned blockSize = 32768;
+    unsigned nBlocks = ( size + blockSize - 1u ) / blockSize;
+    _header.resize(3 + nBlocks);
+    _header[0] = nBlocks;
+    _header[1] = blockSize;
+    _header[2] = ( size % blockSize == 0 && size > 0 ) ? blockSize : size % blockSize;
+
+    uLong maxBlockSize = compressBound(blockSize);
+    if( _compressionBuffer.size() < nBlocks * maxBlockSize ) _compressionBuffer.resize(nBlocks * maxBlockSize);
+
+    compressedSize = 0;
+    for( unsigned i = 0; i < nBlocks; i++ ) {
+      uLong sourceSize = ( i == nBlocks - 1u ) ? _header[2] : blockSize;
+      uLongf destinationSize = maxBlockSize;
+      compress2(reinterpret_cast < Bytef* > (&_compressionBuffer[compressedSize]), &destinationSize,
+                reinterpret_cast < const Bytef* > (pt_data + i * blockSize), sourceSize, Z_DEFAULT_COMPRESSION);
+      _header[3 + i] = destinationSize;
+      compressedSize += destinationSize;
+    }
+    if( nBlocks > 0 ) pt_data = &_compressionBuffer[0];
+  }
+#endif
+
+  if( _appended ) {
+    const char *pt_header = reinterpret_cast < const char* > (&_header[0]);
+    _appendedData.insert(_appendedData.end(), pt_header, pt_header + _header.size() * sizeof(unsigned));
+    _appendedData.insert(_appendedData.end(), pt_data, pt_data + compressedSize);
+  }
+  else {
+    PrintBase64(fout, &_header[0], _header.size() * sizeof(unsigned));
+    PrintBase64(fout, pt_data, compressedSize);
+  }
+}
+
+
 void VTKWriter::Pwrite(const std::string output_path, const char order[], const std::vector < std::string > & vars, const unsigned time_step) {
 
   // *********** open vtu files *************
-  std::ofstream fout;
+  // with asynchronous or aggregated output the vtu file is staged in memory
+  bool staged = ( _outputQueue != NULL || _aggregatedOutput );
+  std::ofstream ffout;
+  std::ostringstream sfout;
+  std::ostream &fout = ( staged ) ? static_cast < std::ostream& > (sfout) : ffout;
+
+  // the pieces gathered in one file have their data inline: the appended offsets are relative to each piece
+  bool appended = _appended;
+  if( _aggregatedOutput ) _appended = false;
+
+  ClearOutputSolutions();
 
   std::string dirnamePVTK = "VTKParallelFiles/";
   Files files;
@@ -62,19 +175,26 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   else filename_prefix = "mesh";
 
   std::ostringstream filename;
-  filename << output_path << "/"<<dirnamePVTK<< filename_prefix << ".level" << _gridn << "." <<_iproc<<"."<< time_step << "." << order << ".vtu";
+  filename << output_path << "/"<<dirnamePVTK<< filename_prefix << ".level" << _gridn << "." <<GetOutputFileIndex()<<"."<< time_step << "." << order << ".vtu";
 
-  fout.open(filename.str().c_str());
-  if (!fout.is_open()) {
-    std::cout << std::endl << " The output file "<< filename.str() <<" cannot be opened.\n";
-    abort();
+  if( !staged ) {
+    ffout.open(filename.str().c_str(), std::ios::out | std::ios::binary);
+    if (!ffout.is_open()) {
+      std::cout << std::endl << " The output file "<< filename.str() <<" cannot be opened.\n";
+      abort();
+    }
   }
 
+  _appendedData.resize(0);
+
   // *********** write vtu header ************
   fout<<"<?xml version=\"1.0\"?>" << std::endl;
-  fout<<"<VTKFile type = \"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+  fout<<"<VTKFile type = \"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\"" << Compressor() << ">" << std::endl;
   fout << "  <UnstructuredGrid>" << std::endl;
 
+  // a static mesh is computed only once: the following outputs print the stored coordinates and cell arrays
+  bool writeMesh = MeshHasToBeWritten(output_path + "/" + dirnamePVTK, index, time_step);
+
   // *********** open pvtu file *************
   std::ofstream Pfout;
   if(_iproc!=0) {
@@ -95,11 +215,11 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
   // *********** write pvtu header ***********
   Pfout<<"<?xml version=\"1.0\"?>" << std::endl;
-  Pfout<<"<VTKFile type = \"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+  Pfout<<"<VTKFile type = \"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\"" << Compressor() << ">" << std::endl;
   Pfout<< "  <PUnstructuredGrid GhostLevel=\"0\">" << std::endl;
-  for(int jproc=0;jproc<_nprocs;jproc++){
+  for(unsigned jfile=0;jfile<GetNumberOfOutputFiles();jfile++){
     Pfout<<"    <Piece Source=\""<<dirnamePVTK
-         << filename_prefix << ".level" << _gridn << "." <<jproc<<"."<< time_step << "." << order << ".vtu"
+         << filename_prefix << ".level" << _gridn << "." <<jfile<<"."<< time_step << "." << order << ".vtu"
 	 <<"\"/>" << std::endl;
   }
   // ****************************************
@@ -112,6 +232,13 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
     nvt += nvt_ig;
   }
 
+  // the own elements of the output region
+  unsigned elementOffset = _ml_mesh->GetLevel(_gridn-1u)->_elementOffset[_iproc];
+  std::vector < bool > writtenElement(_ml_mesh->GetLevel(_gridn-1u)->_elementOffset[_iproc+1] - elementOffset);
+  for (unsigned iel = 0; iel < writtenElement.size(); iel++) {
+    writtenElement[iel] = ElementIsWritten(_gridn-1u, elementOffset + iel);
+  }
+
   map < unsigned, unsigned > ghostMap;
 
   // count the ghost node dofs and the own element dofs element on all levels
@@ -124,7 +251,7 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   for (unsigned ig = _gridr-1u; ig<_gridn; ig++) {
     unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
     for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
+      if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
 	nel++;
 	short unsigned ielt = _ml_mesh->GetLevel(ig)->GetElementType(iel);
 	for (unsigned j=0; j<_ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index); j++) {
@@ -147,31 +274,57 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   unsigned nvtOwned = nvt;
   nvt += ghostMap.size(); // total node dofs (own + ghost)
 
-  const unsigned dim_array_coord [] = { nvt*3*sizeof(float) };
+  // for a region output only the nodes of the written elements are printed, in the same order
+  std::vector < int > nodeIndex;
+  unsigned nvtPrinted = nvt;
+  if( _outputRegion ) {
+    nodeIndex.assign(nvt, -1);
+    gridOffset = 0;
+    unsigned offset_nvt = 0;
+    for (unsigned ig = _gridr-1u; ig<_gridn; ig++) {
+      unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
+      for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
+        if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
+          for (unsigned j=0; j<_ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index); j++) {
+            unsigned jnodeMetis = _ml_mesh->GetLevel(ig)->GetSolutionDof(j, iel, index);
+            unsigned vtkNode = (jnodeMetis >= offset_iprc )? offset_nvt + jnodeMetis - offset_iprc :
+                                                             nvtOwned + ghostMap[gridOffset+jnodeMetis];
+            nodeIndex[vtkNode] = 0;
+          }
+        }
+      }
+      offset_nvt += _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
+      gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+    }
+    nvtPrinted = 0;
+    for (unsigned ii = 0; ii < nvt; ii++) {
+      if( nodeIndex[ii] == 0 ) {
+        nodeIndex[ii] = nvtPrinted;
+        nvtPrinted++;
+      }
+    }
+  }
+
+  const unsigned dim_array_coord [] = { nvtPrinted*3*sizeof(float) };
   const unsigned dim_array_conn[]   = { counter*sizeof(int) };
   const unsigned dim_array_off []   = { nel*sizeof(int) };
   const unsigned dim_array_type []  = { nel*sizeof(short unsigned) };
   const unsigned dim_array_reg []   = { nel*sizeof(short unsigned) };
   const unsigned dim_array_elvar [] = { nel*sizeof(float) };
-  const unsigned dim_array_ndvar [] = { nvt*sizeof(float) };
+  const unsigned dim_array_ndvar [] = { nvtPrinted*sizeof(float) };
 
-  // initialize common buffer_void memory
-  unsigned buffer_size=(dim_array_coord[0]>dim_array_conn[0])? dim_array_coord[0] : dim_array_conn[0];
-  void *buffer_void=new char [buffer_size];
-  char *buffer_char=static_cast <char *>(buffer_void);
+  // initialize common buffer_void memory, kept between the calls
+  unsigned buffer_size=(nvt*3*sizeof(float)>dim_array_conn[0])? nvt*3*sizeof(float) : dim_array_conn[0];
+  if( _dataBuffer.size() < buffer_size || _dataBuffer.size() == 0 ) _dataBuffer.resize(buffer_size + 1u);
+  void *buffer_void=&_dataBuffer[0];
 
-  size_t cch;
-  cch = b64::b64_encode(&buffer_char[0], buffer_size , NULL, 0);
-  vector <char> enc;
-  enc.resize(cch);
-  char *pt_char;
-
-  fout  << "    <Piece NumberOfPoints= \"" << nvt << "\" NumberOfCells= \"" << nel << "\" >" << std::endl;
+  std::streamoff pieceBegin = sfout.tellp();
+  fout  << "    <Piece NumberOfPoints= \"" << nvtPrinted << "\" NumberOfCells= \"" << nel << "\" >" << std::endl;
 
   //-----------------------------------------------------------------------------------------------
   // print coordinates *********************************************Solu*******************************************
   fout  << "      <Points>" << std::endl;
-  fout  << "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" " << DataArrayFormat() << ">" << std::endl;
 
   Pfout << "    <PPoints>" << std::endl;
   Pfout << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"binary\"/>" << std::endl;
@@ -191,98 +344,95 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
     }
   }
 
-  // point pointer to common mamory area buffer of void type;
-  float *var_coord= static_cast<float*>(buffer_void);
-  unsigned offset_ig = 0;
-  for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-    unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
-    unsigned nvt_ig = _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
-    for (int i = 0; i < 3; i++) {
-      if( !_surface ){
-	mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
-	if( _graph && i == 2 ){
-	  unsigned indGraph=_ml_sol->GetIndex(_graphVariable.c_str());
-	  mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indGraph],
-                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraph)) );
-	}
-      }
-      else {
-        unsigned indSurfVar=_ml_sol->GetIndex(_surfaceVariables[i].c_str());
-        mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indSurfVar],
-                               *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
-      }
-      for (unsigned ii = 0; ii < nvt_ig; ii++) {
-	var_coord[ offset_ig + ii*3 + i] = (*mysol[ig])(ii + offset_iprc);
-      }
-      if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  { // if moving mesh
-	unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
-	mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indDXDYDZ],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
-	for (unsigned ii=0; ii<nvt_ig; ii++)
- 	  var_coord[ offset_ig + ii*3 + i] += (*mysol[ig])(ii + offset_iprc);
+  if (writeMesh) {
+    // point pointer to common mamory area buffer of void type;
+    float *var_coord= static_cast<float*>(buffer_void);
+    unsigned offset_ig = 0;
+    for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+      unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
+      unsigned nvt_ig = _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
+      for (int i = 0; i < 3; i++) {
+        if( !_surface ){
+          mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,2) );
+          if( _graph && i == 2 ){
+            unsigned indGraph=_ml_sol->GetIndex(_graphVariable.c_str());
+            mysol[ig]->matrix_mult(*GetOutputSolution(ig, indGraph),
+                                   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraph)) );
+          }
+        }
+        else {
+          unsigned indSurfVar=_ml_sol->GetIndex(_surfaceVariables[i].c_str());
+          mysol[ig]->matrix_mult(*GetOutputSolution(ig, indSurfVar),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
+        }
+        for (unsigned ii = 0; ii < nvt_ig; ii++) {
+          var_coord[ offset_ig + ii*3 + i] = (*mysol[ig])(ii + offset_iprc);
+        }
+        if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  { // if moving mesh
+          unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          mysol[ig]->matrix_mult(*GetOutputSolution(ig, indDXDYDZ),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
+          for (unsigned ii=0; ii<nvt_ig; ii++)
+            var_coord[ offset_ig + ii*3 + i] += (*mysol[ig])(ii + offset_iprc);
+        }
       }
+      offset_ig += 3 * nvt_ig;
     }
-    offset_ig += 3 * nvt_ig;
-  }
-  //print ghost nodes
-  for (int i=0; i<3; i++) {
-    for (unsigned ig = _gridr-1u; ig<_gridn; ig++) {
-      if( !_surface ){
-	mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)-> _topology->_Sol[i],
-			       *_ml_mesh->GetLevel(ig)-> GetQitoQjProjection(index,2) );
-	if( _graph && i == 2){
-	  unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
-	  mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indGraphVar],
-				 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
-	}
-      }
-      else {
-        unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
-        mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indSurfVar],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
-      }
+    //print ghost nodes
+    for (int i=0; i<3; i++) {
+      for (unsigned ig = _gridr-1u; ig<_gridn; ig++) {
+        if( !_surface ){
+          mysol[ig]->matrix_mult(*_ml_mesh->GetLevel(ig)-> _topology->_Sol[i],
+                                 *_ml_mesh->GetLevel(ig)-> GetQitoQjProjection(index,2) );
+          if( _graph && i == 2){
+            unsigned indGraphVar = _ml_sol->GetIndex(_graphVariable.c_str());
+            mysol[ig]->matrix_mult(*GetOutputSolution(ig, indGraphVar),
+                                   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indGraphVar)) );
+          }
+        }
+        else {
+          unsigned indSurfVar = _ml_sol->GetIndex(_surfaceVariables[i].c_str());
+          mysol[ig]->matrix_mult(*GetOutputSolution(ig, indSurfVar),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indSurfVar)) );
+        }
 
-    }
-    gridOffset = 0;
-    unsigned ig = _gridr-1u;
-    for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
-      while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
-	gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-	ig++;
-      }
-      var_coord[ offset_ig + 3*it->second + i ] = (*mysol[ig])( it->first - gridOffset);
-    }
-  }
-  for (int i=0; i<3; i++) {  // if moving mesh
-    if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  {
-      unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
-      for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-	mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indDXDYDZ],
-			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
       }
       gridOffset = 0;
       unsigned ig = _gridr-1u;
       for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
-	while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
-	  gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
-	  ig++;
-	}
-	var_coord[ offset_ig + 3*it->second + i ] += (*mysol[ig])( it->first - gridOffset);
+        while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
+          gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+          ig++;
+        }
+        var_coord[ offset_ig + 3*it->second + i ] = (*mysol[ig])( it->first - gridOffset);
+      }
+    }
+    for (int i=0; i<3; i++) {  // if moving mesh
+      if (_ml_sol != NULL && _moving_mesh  && _ml_mesh->GetLevel(0)->GetDimension() > i)  {
+        unsigned indDXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+        for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+          mysol[ig]->matrix_mult(*GetOutputSolution(ig, indDXDYDZ),
+                                 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(indDXDYDZ)) );
+        }
+        gridOffset = 0;
+        unsigned ig = _gridr-1u;
+        for (std::map <unsigned, unsigned>::iterator it=ghostMap.begin(); it!=ghostMap.end(); ++it){
+          while( it->first >= gridOffset + _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] ) {
+            gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+            ig++;
+          }
+          var_coord[ offset_ig + 3*it->second + i ] += (*mysol[ig])( it->first - gridOffset);
+        }
       }
     }
+    if( _outputRegion ) CompactNodeValues(var_coord, nodeIndex, 3);
+    _meshCoordinates[index].resize(dim_array_coord[0] + 1u);
+    memcpy(&_meshCoordinates[index][0], buffer_void, dim_array_coord[0]);
   }
 
-  cch = b64::b64_encode(&dim_array_coord[0], sizeof(dim_array_coord), NULL, 0);
-  b64::b64_encode(&dim_array_coord[0], sizeof(dim_array_coord), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
   //print coordinates array
-  cch = b64::b64_encode(&var_coord[0], dim_array_coord[0] , NULL, 0);
-  b64::b64_encode(&var_coord[0], dim_array_coord[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &_meshCoordinates[index][0], dim_array_coord[0]);
   fout << std::endl;
 
   fout  << "        </DataArray>" << std::endl;
@@ -296,83 +446,74 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   Pfout << "    <PCells>" << std::endl;
   //-----------------------------------------------------------------------------------------------
   //print connectivity
-  fout  << "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Int32\" Name=\"connectivity\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"Int32\" Name=\"connectivity\" format=\"binary\"/>" << std::endl;
 
-  // point pointer to common mamory area buffer of void type;
-  int *var_conn = static_cast <int*> (buffer_void);
-  icount = 0;
-  //ghost_counter = 0;
-  gridOffset = 0;
-  unsigned offset_nvt=0;
-  for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-    unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
-    unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
-    for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
-	for (unsigned j=0; j<_ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index); j++) {
-	  unsigned loc_vtk_conn = FemusToVTKorToXDMFConn[j];
-	  //unsigned jnode=_ml_mesh->GetLevel(ig)->el->GetMeshDof(iel, loc_vtk_conn, index);
-	  unsigned jnodeMetis = _ml_mesh->GetLevel(ig)->GetSolutionDof(loc_vtk_conn, iel, index);
-	  var_conn[icount] = (jnodeMetis >= offset_iprc )? offset_nvt + jnodeMetis - offset_iprc :
-							   nvtOwned + ghostMap[gridOffset+jnodeMetis];
-	  icount++;
-	}
+  if (writeMesh) {
+    // point pointer to common mamory area buffer of void type;
+    int *var_conn = static_cast <int*> (buffer_void);
+    icount = 0;
+    //ghost_counter = 0;
+    gridOffset = 0;
+    unsigned offset_nvt=0;
+    for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+      unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
+      unsigned nvt_ig= _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
+      for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
+        if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
+          for (unsigned j=0; j<_ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index); j++) {
+            unsigned loc_vtk_conn = FemusToVTKorToXDMFConn[j];
+            //unsigned jnode=_ml_mesh->GetLevel(ig)->el->GetMeshDof(iel, loc_vtk_conn, index);
+            unsigned jnodeMetis = _ml_mesh->GetLevel(ig)->GetSolutionDof(loc_vtk_conn, iel, index);
+            var_conn[icount] = (jnodeMetis >= offset_iprc )? offset_nvt + jnodeMetis - offset_iprc :
+                                                             nvtOwned + ghostMap[gridOffset+jnodeMetis];
+            if( _outputRegion ) var_conn[icount] = nodeIndex[ var_conn[icount] ];
+            icount++;
+          }
+        }
       }
+      offset_nvt+= nvt_ig;
+      gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
     }
-    offset_nvt+= nvt_ig;
-    gridOffset += _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs];
+    _meshConnectivity[index].resize(dim_array_conn[0] + 1u);
+    memcpy(&_meshConnectivity[index][0], buffer_void, dim_array_conn[0]);
   }
 
-  //print connectivity dimension
-  cch = b64::b64_encode(&dim_array_conn[0], sizeof(dim_array_conn), NULL, 0);
-  b64::b64_encode(&dim_array_conn[0], sizeof(dim_array_conn), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
   //print connectivity array
-  cch = b64::b64_encode(&var_conn[0], dim_array_conn[0] , NULL, 0);
-  b64::b64_encode(&var_conn[0], dim_array_conn[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &_meshConnectivity[index][0], dim_array_conn[0]);
   fout << std::endl;
   fout << "        </DataArray>" << std::endl;
   //------------------------------------------------------------------------------------------------
 
   //-------------------------------------------------------------------------------------------------
   //printing offset
-  fout  << "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Int32\" Name=\"offsets\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"Int32\" Name=\"offsets\" format=\"binary\"/>" << std::endl;
 
 
 
-  // point pointer to common mamory area buffer of void type;
-  int *var_off=static_cast <int*>(buffer_void);
-  icount = 0;
-  int offset_el=0;
-  //print offset array
+  if (writeMesh) {
+    // point pointer to common mamory area buffer of void type;
+    int *var_off=static_cast <int*>(buffer_void);
+    icount = 0;
+    int offset_el=0;
+    //print offset array
 
-  for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-    for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
-	offset_el += _ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index);
-        var_off[icount] = offset_el;
-	icount++;
+    for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+      for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
+        if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
+          offset_el += _ml_mesh->GetLevel(ig)->GetElementDofNumber(iel,index);
+          var_off[icount] = offset_el;
+          icount++;
+        }
       }
     }
+    _meshOffsets[index].resize(dim_array_off[0] + 1u);
+    memcpy(&_meshOffsets[index][0], buffer_void, dim_array_off[0]);
   }
 
-  //print offset dimension
-  cch = b64::b64_encode(&dim_array_off[0], sizeof(dim_array_off), NULL, 0);
-  b64::b64_encode(&dim_array_off[0], sizeof(dim_array_off), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
   //print offset array
-  cch = b64::b64_encode(&var_off[0], dim_array_off[0] , NULL, 0);
-  b64::b64_encode(&var_off[0], dim_array_off[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &_meshOffsets[index][0], dim_array_off[0]);
 
   fout  << std::endl;
 
@@ -381,33 +522,28 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
   //--------------------------------------------------------------------------------------------------
   //Element format type : 23:Serendipity(8-nodes)  28:Quad9-Biquadratic
-  fout  << "        <DataArray type=\"UInt16\" Name=\"types\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"UInt16\" Name=\"types\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"UInt16\" Name=\"types\" format=\"binary\"/>" << std::endl;
 
-  // point pointer to common mamory area buffer of void type;
-  unsigned short *var_type = static_cast <unsigned short*> (buffer_void);
-  icount=0;
-  for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-    for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
-	short unsigned ielt= _ml_mesh->GetLevel(ig)->GetElementType(iel);
-	var_type[icount] = femusToVtkCellType[index][ielt];
-	icount++;
+  if (writeMesh) {
+    // point pointer to common mamory area buffer of void type;
+    unsigned short *var_type = static_cast <unsigned short*> (buffer_void);
+    icount=0;
+    for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+      for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
+        if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
+          short unsigned ielt= _ml_mesh->GetLevel(ig)->GetElementType(iel);
+          var_type[icount] = femusToVtkCellType[index][ielt];
+          icount++;
+        }
       }
     }
+    _meshTypes[index].resize(dim_array_type[0] + 1u);
+    memcpy(&_meshTypes[index][0], buffer_void, dim_array_type[0]);
   }
 
-  //print element format dimension
-  cch = b64::b64_encode(&dim_array_type[0], sizeof(dim_array_type), NULL, 0);
-  b64::b64_encode(&dim_array_type[0], sizeof(dim_array_type), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
   //print element format array
-  cch = b64::b64_encode(&var_type[0], dim_array_type[0] , NULL, 0);
-  b64::b64_encode(&var_type[0], dim_array_type[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &_meshTypes[index][0], dim_array_type[0]);
 
   fout  << std::endl;
   fout  << "        </DataArray>" << std::endl;
@@ -494,7 +630,7 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
 
   // Print Metis Partitioning
-  fout  << "        <DataArray type=\"UInt16\" Name=\"Metis partition\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"UInt16\" Name=\"Metis partition\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"UInt16\" Name=\"Metis partition\" format=\"binary\"/>" << std::endl;
 
   // point pointer to common mamory area buffer of void type;
@@ -503,25 +639,17 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   icount=0;
   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
     for (int iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
+      if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
         var_proc[icount]=_iproc;
 	icount++;
       }
     }
   }
 
-  //print regions dimension
-  cch = b64::b64_encode(&dim_array_reg[0], sizeof(dim_array_reg), NULL, 0);
-  b64::b64_encode(&dim_array_reg[0], sizeof(dim_array_reg), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++, pt_char++) fout << *pt_char;
 
 
   //print regions array
-  cch = b64::b64_encode(&var_proc[0], dim_array_reg[0] , NULL, 0);
-  b64::b64_encode(&var_proc[0], dim_array_reg[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &var_proc[0], dim_array_reg[0]);
 
   fout  << std::endl;
   fout  << "        </DataArray>" << std::endl;
@@ -534,30 +662,22 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
   NumericVector &material =  _ml_mesh->GetLevel(_gridn-1)->_topology->GetSolutionName("Material");
 
-  fout  << "        <DataArray type=\"Float32\" Name=\"" << "Material" <<"\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Float32\" Name=\"" << "Material" <<"\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"Float32\" Name=\"" << "Material" <<"\" format=\"binary\"/>" << std::endl;
   // point pointer to common memory area buffer of void type;
   float *var_el = static_cast< float*> (buffer_void);
   icount=0;
   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
     for (unsigned iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
+      if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
 	unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0, iel, 3);
 	var_el[icount] = (material)(iel_Metis);
 	icount++;
       }
     }
   }
-  //print solution on element dimension
-  cch = b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), NULL, 0);
-  b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
   //print solution on element array
-  cch = b64::b64_encode(&var_el[0], dim_array_elvar[0] , NULL, 0);
-  b64::b64_encode(&var_el[0], dim_array_elvar[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &var_el[0], dim_array_elvar[0]);
   fout << std::endl;
   fout << "        </DataArray>" << std::endl;
 
@@ -565,60 +685,44 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
     NumericVector &group =  _ml_mesh->GetLevel(_gridn-1)->_topology->GetSolutionName("Group");
 
-  fout  << "        <DataArray type=\"Float32\" Name=\"" << "Group" <<"\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Float32\" Name=\"" << "Group" <<"\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"Float32\" Name=\"" << "Group" <<"\" format=\"binary\"/>" << std::endl;
   // point pointer to common memory area buffer of void type;
   var_el = static_cast< float*> (buffer_void);
   icount=0;
   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
     for (unsigned iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
+      if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
 	unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0, iel, 3);
 	var_el[icount] = (group)(iel_Metis);
 	icount++;
       }
     }
   }
-  //print solution on element dimension
-  cch = b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), NULL, 0);
-  b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
   //print solution on element array
-  cch = b64::b64_encode(&var_el[0], dim_array_elvar[0] , NULL, 0);
-  b64::b64_encode(&var_el[0], dim_array_elvar[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &var_el[0], dim_array_elvar[0]);
   fout << std::endl;
   fout << "        </DataArray>" << std::endl;
 
   //-------------------------------------------------------TYPE--------------------------------------------------
     NumericVector &type =  _ml_mesh->GetLevel(_gridn-1)->_topology->GetSolutionName("Type");
 
-  fout  << "        <DataArray type=\"Float32\" Name=\"" << "TYPE" <<"\" format=\"binary\">" << std::endl;
+  fout  << "        <DataArray type=\"Float32\" Name=\"" << "TYPE" <<"\" " << DataArrayFormat() << ">" << std::endl;
   Pfout << "      <PDataArray type=\"Float32\" Name=\"" << "TYPE" <<"\" format=\"binary\"/>" << std::endl;
   // point pointer to common memory area buffer of void type;
   var_el = static_cast< float*> (buffer_void);
   icount=0;
   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
     for (unsigned iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-      if ( ig == _gridn-1u ) {
+      if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
 	unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0, iel, 3);
 	var_el[icount] = (type)(iel_Metis);
 	icount++;
       }
     }
   }
-  //print solution on element dimension
-  cch = b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), NULL, 0);
-  b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
   //print solution on element array
-  cch = b64::b64_encode(&var_el[0], dim_array_elvar[0] , NULL, 0);
-  b64::b64_encode(&var_el[0], dim_array_elvar[0], &enc[0], cch);
-  pt_char=&enc[0];
-  for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+  PrintDataArray(fout, &var_el[0], dim_array_elvar[0]);
   fout << std::endl;
   fout << "        </DataArray>" << std::endl;
 
@@ -626,10 +730,6 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 
 
 
-    if (_ml_sol == NULL) {
-    delete [] var_proc;
-  }
-
   bool print_all = 0;
     for (unsigned ivar=0; ivar < vars.size(); ivar++){
       print_all += !(vars[ivar].compare("All")) + !(vars[ivar].compare("all")) + !(vars[ivar].compare("ALL"));
@@ -639,32 +739,23 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
     for (unsigned i=0; i<(!print_all)*vars.size() + print_all*_ml_sol->GetSolutionSize(); i++) {
       unsigned solIndex=( print_all == 0 ) ? _ml_sol->GetIndex(vars[i].c_str()):i;
       if (3 <= _ml_sol->GetSolutionType(solIndex)) {
-	fout  << "        <DataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" format=\"binary\">" << std::endl;
+	fout  << "        <DataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" " << DataArrayFormat() << ">" << std::endl;
 	Pfout << "      <PDataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" format=\"binary\"/>" << std::endl;
 	// point pointer to common memory area buffer of void type;
 	float *var_el = static_cast< float*> (buffer_void);
 	icount=0;
 	for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
 	  for (unsigned iel=_ml_mesh->GetLevel(ig)->_elementOffset[_iproc]; iel < _ml_mesh->GetLevel(ig)->_elementOffset[_iproc+1]; iel++) {
-	    if ( ig == _gridn-1u ) {
+	    if ( ig == _gridn-1u && writtenElement[iel - elementOffset] ) {
 	      unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0, iel, _ml_sol->GetSolutionType(i));
-	      var_el[icount] = (*_ml_sol->GetSolutionLevel(ig)->_Sol[i])(iel_Metis);
+	      var_el[icount] = (*GetOutputSolution(ig, i))(iel_Metis);
 	      icount++;
 	    }
 	  }
 	}
 
-	//print solution on element dimension
-	cch = b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), NULL, 0);
-	b64::b64_encode(&dim_array_elvar[0], sizeof(dim_array_elvar), &enc[0], cch);
-	pt_char=&enc[0];
-	for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
 	//print solution on element array
-	cch = b64::b64_encode(&var_el[0], dim_array_elvar[0] , NULL, 0);
-	b64::b64_encode(&var_el[0], dim_array_elvar[0], &enc[0], cch);
-	pt_char=&enc[0];
-	for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+	PrintDataArray(fout, &var_el[0], dim_array_elvar[0]);
 	fout << std::endl;
 	fout << "        </DataArray>" << std::endl;
 	//----------------------------------------------------------------------------------------------------
@@ -694,21 +785,15 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
   for (unsigned i=0; i< (!print_all)*vars.size() + print_all*_ml_sol->GetSolutionSize(); i++) {
     unsigned solIndex=( print_all == 0 )?_ml_sol->GetIndex(vars[i].c_str()):i;
     if (_ml_sol->GetSolutionType(solIndex)<3) {
-      fout  << "        <DataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" format=\"binary\">" << std::endl;
+      fout  << "        <DataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" " << DataArrayFormat() << ">" << std::endl;
       Pfout << "      <PDataArray type=\"Float32\" Name=\"" << _ml_sol->GetSolutionName(solIndex) <<"\" format=\"binary\"/>" << std::endl;
 
-      //print solutions on nodes dimension
-      cch = b64::b64_encode(&dim_array_ndvar[0], sizeof(dim_array_ndvar), NULL, 0);
-      b64::b64_encode(&dim_array_ndvar[0], sizeof(dim_array_ndvar), &enc[0], cch);
-      pt_char=&enc[0];
-      for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
-
       unsigned offset_ig = 0;
       for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
 	unsigned offset_iprc = _ml_mesh->GetLevel(ig)->_dofOffset[index][_iproc];
 	unsigned nvt_ig = _ml_mesh->GetLevel(ig)->_ownSize[index][_iproc];
 
-	mysol[ig]->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[solIndex],
+	mysol[ig]->matrix_mult(*GetOutputSolution(ig, solIndex),
 			       *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index,_ml_sol->GetSolutionType(solIndex)) );
 
 	for (unsigned ii = 0; ii < nvt_ig; ii++) {
@@ -727,11 +812,9 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
 	}
 	var_nd[ offset_ig + it->second ] = (*mysol[ig])( it->first - gridOffset);
       }
+      if( _outputRegion ) CompactNodeValues(var_nd, nodeIndex, 1);
 
-      cch = b64::b64_encode(&var_nd[0], dim_array_ndvar [0], NULL, 0);
-      b64::b64_encode(&var_nd[0], dim_array_ndvar [0], &enc[0], cch);
-      pt_char=&enc[0];
-      for( unsigned i =0; i<cch;i++,pt_char++) fout << *pt_char;
+      PrintDataArray(fout, &var_nd[0], dim_array_ndvar[0]);
       fout << std::endl;
 
       fout  << "        </DataArray>" << std::endl;
@@ -739,15 +822,40 @@ void VTKWriter::Pwrite(const std::string output_path, const char order[], const
     } // end for sol
     fout  << "      </PointData>" << std::endl;
     Pfout << "    </PPointData>" << std::endl;
-    delete [] var_nd;
   }  //end _ml_sol != NULL
 
   //------------------------------------------------------------------------------------------------
 
   fout << "    </Piece>" << std::endl;
+  std::streamoff pieceEnd = sfout.tellp();
   fout << "  </UnstructuredGrid>" << std::endl;
+  if( _appended ){
+    fout << "  <AppendedData encoding=\"raw\">" << std::endl << "_";
+    if( _appendedData.size() > 0 ) fout.write(&_appendedData[0], _appendedData.size());
+    fout << std::endl << "  </AppendedData>" << std::endl;
+  }
   fout << "</VTKFile>" << std::endl;
-  fout.close();
+  if( _aggregatedOutput ) {
+    // the first process of the group writes the pieces of all the processes of the group in its file
+    std::string stagingBuffer = sfout.str();
+    std::string piece = stagingBuffer.substr(pieceBegin, pieceEnd - pieceBegin);
+    std::vector < std::string > groupPieces;
+    std::vector < unsigned > groupInfo;
+    if( GatherGroupPieces(piece, std::vector < unsigned > (), groupPieces, groupInfo) ) {
+      std::string fileBuffer = stagingBuffer.substr(0, pieceBegin);
+      for( unsigned j = 0; j < groupPieces.size(); j++ ) fileBuffer += groupPieces[j];
+      fileBuffer += stagingBuffer.substr(pieceEnd);
+      WriteStagedFile(filename.str(), fileBuffer);
+    }
+    _appended = appended;
+  }
+  else if( _outputQueue != NULL ) {
+    std::string stagingBuffer = sfout.str();
+    _outputQueue->Push(filename.str(), stagingBuffer);
+  }
+  else {
+    ffout.close();
+  }
 
   Pfout << "  </PUnstructuredGrid>" << std::endl;
   Pfout << "</VTKFile>" << std::endl;
@@ -20,6 +20,7 @@
 // includes :
 //----------------------------------------------------------------------------
 #include "Writer.hpp"
+#include <fstream>
 
 
 namespace femus {
@@ -50,7 +51,44 @@ public:
       Pwrite(output_path, order, vars, time_step);
     };
     void Pwrite(const std::string output_path, const char order[], const std::vector < std::string > & vars = std::vector < std::string > (), const unsigned time_step=0) ;
+
+    /** Write the data arrays as raw binary in the appended section of the vtu files, instead of inline base64 */
+    void SetAppendedBinaryOutput(bool value){ _appended = value; };
+
+    /** Compress the data arrays with zlib */
+    void SetCompressedOutput(bool value);
+
+    /** Write the vtu files in background while the computation goes on (the encoding stays in the time loop) */
+    void SetAsynchronousOutput(const unsigned &maxPendingWrites){ StartOutputQueue(maxPendingWrites); };
+
 private:
+
+    /** The format and offset attributes of the next DataArray */
+    std::string DataArrayFormat() const;
+
+    /** The compressor attribute of the VTKFile */
+    std::string Compressor() const;
+
+    /** Print the header and the (compressed) data of a DataArray, inline in base64 or in the appended buffer */
+    void PrintDataArray(std::ostream &fout, const void *data, const unsigned &size);
+
+    void PrintBase64(std::ostream &fout, const void *data, const unsigned &size);
+
+    bool _appended;
+    bool _compressed;
+
+    /** buffers reused for all the fields and time steps */
+    std::vector < char > _dataBuffer;
+    std::vector < char > _encodingBuffer;
+    std::vector < char > _compressionBuffer;
+    std::vector < char > _appendedData;
+    std::vector < unsigned > _header;
+
+    /** the coordinates and cell arrays of the last printed static mesh, for each order */
+    std::vector < char > _meshCoordinates[3];
+    std::vector < char > _meshConnectivity[3];
+    std::vector < char > _meshOffsets[3];
+    std::vector < char > _meshTypes[3];
   
     /** femus to vtk cell type map */
     static short unsigned int femusToVtkCellType[3][6];
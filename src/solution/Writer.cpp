@@ -28,6 +28,11 @@
 #include "VTKWriter.hpp"
 #include "GMVWriter.hpp"
 #include "XDMFWriter.hpp"
+#include "OutputQueue.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
 
 
 
@@ -44,6 +49,12 @@ namespace femus {
     _moving_mesh = 0;
     _graph = false;
     _surface = false;
+    _outputQueue = NULL;
+    _outputRegion = false;
+    _outputBoundaryElements = false;
+    _aggregatedOutput = false;
+    _outputFiles = 0;
+    _outputComm = MPI_COMM_NULL;
   }
 
   Writer::Writer( MultiLevelMesh* ml_mesh ):
@@ -54,9 +65,19 @@ namespace femus {
     _moving_mesh = 0;
     _graph = false;
     _surface = false;
+    _outputQueue = NULL;
+    _outputRegion = false;
+    _outputBoundaryElements = false;
+    _aggregatedOutput = false;
+    _outputFiles = 0;
+    _outputComm = MPI_COMM_NULL;
   }
 
-  Writer::~Writer() { }
+  Writer::~Writer() {
+    delete _outputQueue;
+    ClearOutputSolutions();
+    if( _outputComm != MPI_COMM_NULL ) MPI_Comm_free(&_outputComm);
+  }
 
 
   std::auto_ptr<Writer> Writer::build(const WriterEnum format, MultiLevelSolution * ml_sol)  {
@@ -104,6 +125,42 @@ namespace femus {
     _moving_vars = movvars_in;
   }
 
+  bool Writer::MeshHasToBeWritten(const std::string &output_path, const unsigned &index, const unsigned &time_step){
+
+    std::vector < unsigned > signature;
+    signature.reserve( 2 * _gridn + 2 );
+    signature.push_back( _gridn );
+    signature.push_back( _gridr );
+    for(unsigned ig = 0; ig < _gridn; ig++){
+      signature.push_back( _ml_mesh->GetLevel(ig)->GetNumberOfElements() );
+      signature.push_back( _ml_mesh->GetLevel(ig)->_dofOffset[index][_nprocs] );
+    }
+
+    // the mesh changes with the solution: it has to be printed at every call
+    bool movingMesh = ( _ml_sol != NULL && ( _moving_mesh || _graph || _surface ) );
+
+    if( movingMesh || _meshPath[index] != output_path || _meshSignature[index] != signature || _meshTimeStep[index] == time_step ){
+      _meshPath[index] = output_path;
+      _meshSignature[index] = signature;
+      _meshTimeStep[index] = time_step;
+      return true;
+    }
+    return false;
+  }
+
+  void Writer::StartOutputQueue(const unsigned &maxPendingWrites){
+    if( maxPendingWrites == 0 ){
+      delete _outputQueue;
+      _outputQueue = NULL;
+    }
+    else if( _outputQueue == NULL ){
+      _outputQueue = new OutputQueue(maxPendingWrites);
+    }
+    else {
+      _outputQueue->SetMaxPendingWrites(maxPendingWrites);
+    }
+  }
+
   void Writer::SetGraphVariable(const std::string &graphVaraible){
     _graph = true;
     _surface = false;
@@ -116,6 +173,264 @@ namespace femus {
     _surfaceVariables = surfaceVariable;
   }
 
+  void Writer::SetOutputLevel(const unsigned &level){
+    unsigned gridn = _ml_mesh->GetNumberOfLevels();
+    if( level < 1 || level > gridn ){
+      std::cout << "Error! Output level " << level << " out of range [1, " << gridn << "]" << std::endl;
+      abort();
+    }
+    _gridn = level;
+    _gridr = _ml_mesh->GetNumberOfGridTotallyRefined();
+    if( _gridr > _gridn ) _gridr = _gridn;
+  }
+
+  void Writer::SetOutputGroups(const std::vector < unsigned > &groups){
+    _outputGroups = groups;
+    _outputRegion = true;
+    ResetMeshOutput();
+  }
+
+  void Writer::SetOutputMaterials(const std::vector < unsigned > &materials){
+    _outputMaterials = materials;
+    _outputRegion = true;
+    ResetMeshOutput();
+  }
+
+  void Writer::SetOutputBoundingBox(const std::vector < double > &xMin, const std::vector < double > &xMax){
+    if( xMin.size() < _ml_mesh->GetLevel(0)->GetDimension() || xMax.size() < _ml_mesh->GetLevel(0)->GetDimension() ){
+      std::cout << "Error! The bounding box needs one bound for each dimension" << std::endl;
+      abort();
+    }
+    _outputBoxMin = xMin;
+    _outputBoxMax = xMax;
+    _outputRegion = true;
+    ResetMeshOutput();
+  }
+
+  void Writer::SetOutputBoundaryElements(const bool &value){
+    _outputBoundaryElements = value;
+    _outputRegion = ( value || _outputGroups.size() || _outputMaterials.size() || _outputBoxMin.size() );
+    ResetMeshOutput();
+  }
+
+  void Writer::UnsetOutputRegion(){
+    _outputGroups.clear();
+    _outputMaterials.clear();
+    _outputBoxMin.clear();
+    _outputBoxMax.clear();
+    _outputBoundaryElements = false;
+    _outputRegion = false;
+    ResetMeshOutput();
+  }
+
+  void Writer::SetNumberOfOutputFiles(const unsigned &nFiles){
+    if( _outputComm != MPI_COMM_NULL ) MPI_Comm_free(&_outputComm);
+    _outputFiles = ( nFiles < static_cast < unsigned > (_nprocs) ) ? nFiles : 0;
+    _aggregatedOutput = ( _outputFiles > 0 );
+    if( _aggregatedOutput ) {
+      MPI_Comm_split(MPI_COMM_WORLD, GetOutputFileIndex(), _iproc, &_outputComm);
+    }
+    // the static meshes are referred to by file name
+    ResetMeshOutput();
+  }
+
+  unsigned Writer::GetNumberOfOutputFiles() const {
+    return ( _aggregatedOutput ) ? _outputFiles : _nprocs;
+  }
+
+  unsigned Writer::GetOutputFileIndex() const {
+    if( !_aggregatedOutput ) return _iproc;
+    return static_cast < unsigned > ( ( static_cast < unsigned long > (_iproc) * _outputFiles ) / _nprocs );
+  }
+
+  bool Writer::GatherGroupPieces(const std::string &piece, const std::vector < unsigned > &info,
+                                 std::vector < std::string > &groupPieces, std::vector < unsigned > &groupInfo){
+
+    int groupSize, groupRank;
+    MPI_Comm_size(_outputComm, &groupSize);
+    MPI_Comm_rank(_outputComm, &groupRank);
+
+    // the sizes are 64 bit, the pieces of the group can exceed the int counts of MPI
+    unsigned long long pieceSize = piece.size();
+    std::vector < unsigned long long > pieceSizes(groupSize);
+    MPI_Gather(&pieceSize, 1, MPI_UNSIGNED_LONG_LONG, &pieceSizes[0], 1, MPI_UNSIGNED_LONG_LONG, 0, _outputComm);
+    unsigned long long maxPieceSize;
+    MPI_Allreduce(&pieceSize, &maxPieceSize, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, _outputComm);
+
+    int nInfo = info.size();
+    groupInfo.resize(nInfo * groupSize);
+    if( nInfo > 0 ) {
+      MPI_Gather(const_cast < unsigned* > (&info[0]), nInfo, MPI_UNSIGNED, &groupInfo[0], nInfo, MPI_UNSIGNED, 0, _outputComm);
+    }
+
+    if( groupRank == 0 ) {
+      unsigned long long groupBytes = 0;
+      for(int j = 0; j < groupSize; j++) groupBytes += pieceSizes[j];
+      if( groupBytes > piece.max_size() ) {
+        std::cout << std::endl << " The output of the group of process " << _iproc << " (" << groupBytes
+                  << " bytes) exceeds the size of the aggregation buffer, use more output files\n";
+        abort();
+      }
+      groupPieces.resize(groupSize);
+      for(int j = 0; j < groupSize; j++) groupPieces[j].reserve(pieceSizes[j]);
+    }
+
+    // gather the pieces in chunks, so that the counts and the offsets of every MPI_Gatherv stay below INT_MAX
+    unsigned long long chunkSize = std::numeric_limits < int >::max() / groupSize;
+    std::vector < int > chunkSizes(groupSize);
+    std::vector < int > chunkOffsets(groupSize + 1, 0);
+    std::vector < char > buffer;
+    for(unsigned long long chunkStart = 0; chunkStart < maxPieceSize; chunkStart += chunkSize){
+      int sendSize = 0;
+      if( chunkStart < pieceSize ) sendSize = ( pieceSize - chunkStart < chunkSize ) ? pieceSize - chunkStart : chunkSize;
+      if( groupRank == 0 ) {
+        for(int j = 0; j < groupSize; j++){
+          chunkSizes[j] = 0;
+          if( chunkStart < pieceSizes[j] ) chunkSizes[j] = ( pieceSizes[j] - chunkStart < chunkSize ) ? pieceSizes[j] - chunkStart : chunkSize;
+          chunkOffsets[j + 1] = chunkOffsets[j] + chunkSizes[j];
+        }
+        buffer.resize(chunkOffsets[groupSize] + 1);
+      }
+      MPI_Gatherv(const_cast < char* > (piece.data() + ( ( sendSize > 0 ) ? chunkStart : 0 )), sendSize, MPI_CHAR,
+                  ( groupRank == 0 ) ? &buffer[0] : NULL, &chunkSizes[0], &chunkOffsets[0], MPI_CHAR, 0, _outputComm);
+      if( groupRank == 0 ) {
+        for(int j = 0; j < groupSize; j++){
+          groupPieces[j].append(&buffer[chunkOffsets[j]], chunkSizes[j]);
+        }
+      }
+    }
+
+    return ( groupRank == 0 );
+  }
+
+  void Writer::WriteStagedFile(const std::string &filename, std::string &buffer){
+    if( _outputQueue != NULL ) {
+      _outputQueue->Push(filename, buffer);
+    }
+    else {
+      std::ofstream fout(filename.c_str(), std::ios::out | std::ios::binary);
+      if( !fout.is_open() ) {
+        std::cout << std::endl << " The output file "<< filename <<" cannot be opened.\n";
+        abort();
+      }
+      fout.write(buffer.data(), buffer.size());
+      fout.close();
+      buffer.clear();
+    }
+  }
+
+  void Writer::ResetMeshOutput(){
+    for(unsigned i = 0; i < 3; i++){
+      _meshPath[i].clear();
+    }
+  }
+
+  bool Writer::ElementIsWritten(const unsigned &ig, const unsigned &iel) const {
+
+    if( !_outputRegion ) return true;
+
+    Mesh *msh = _ml_mesh->GetLevel(ig);
+
+    if( _outputGroups.size() &&
+        std::find(_outputGroups.begin(), _outputGroups.end(), msh->GetElementGroup(iel)) == _outputGroups.end() ) return false;
+
+    if( _outputMaterials.size() &&
+        std::find(_outputMaterials.begin(), _outputMaterials.end(), msh->GetElementMaterial(iel)) == _outputMaterials.end() ) return false;
+
+    if( _outputBoundaryElements ){
+      bool boundary = false;
+      for(unsigned jface = 0; jface < msh->GetElementFaceNumber(iel); jface++){
+        if( msh->el->GetFaceElementIndex(iel, jface) < 0 ) {
+          boundary = true;
+          break;
+        }
+      }
+      if( !boundary ) return false;
+    }
+
+    if( _outputBoxMin.size() ){
+      // the box is tested on the reference coordinates, also for a moving mesh
+      unsigned dim = msh->GetDimension();
+      for(unsigned j = 0; j < msh->GetElementDofNumber(iel, 0); j++){
+        unsigned jdof = msh->GetSolutionDof(j, iel, 2);
+        bool inside = true;
+        for(unsigned k = 0; k < dim; k++){
+          double xk = (*msh->_topology->_Sol[k])(jdof);
+          if( xk < _outputBoxMin[k] || xk > _outputBoxMax[k] ) {
+            inside = false;
+            break;
+          }
+        }
+        if( inside ) return true;
+      }
+      return false;
+    }
+
+    return true;
+  }
+
+  NumericVector* Writer::GetOutputSolution(const unsigned &ig, const unsigned &solIndex){
+
+    unsigned finestLevel = _ml_mesh->GetNumberOfLevels() - 1u;
+    if( ig + 1u != (unsigned)_gridn || ig == finestLevel ) return _ml_sol->GetSolutionLevel(ig)->_Sol[solIndex];
+
+    std::map < unsigned, NumericVector* >::iterator it = _restrictedSolution.find(solIndex);
+    if( it != _restrictedSolution.end() ) return it->second;
+
+    // restriction level by level: the Lagrangian coarse values are injected from the coinciding fine nodes, the
+    // discontinuous ones are the averages of the fine values; both are P^T (w u_f) / P^T w, with w = 1 on the fine
+    // nodes whose prolongation row is a single unit entry (the nodes of the coarse mesh) or w = 1 everywhere
+    unsigned solType = _ml_sol->GetSolutionType(solIndex);
+    NumericVector *fineSol = _ml_sol->GetSolutionLevel(finestLevel)->_Sol[solIndex]->clone().release();
+    for(unsigned jg = finestLevel; jg > ig; jg--){
+      SparseMatrix *projection = _ml_mesh->GetLevel(jg)->GetCoarseToFineProjection(solType);
+
+      NumericVector *fineWeight = fineSol->clone().release();
+      if( solType < 3 ) {
+        fineWeight->zero();
+        int col;
+        double value;
+        for(int i = projection->row_start(); i < projection->row_stop(); i++){
+          if( projection->MatGetRowM(i) != 1 ) continue;
+          projection->MatGetRowM(i, &col, &value);
+          if( fabs(value - 1.) < 1.0e-12 ) fineWeight->set(i, 1.);
+        }
+        fineWeight->close();
+      }
+      else *fineWeight = 1.;
+
+      NumericVector *weightedSol = fineSol->clone().release();
+      weightedSol->pointwise_mult(*fineSol, *fineWeight);
+
+      NumericVector *coarseSol = _ml_sol->GetSolutionLevel(jg - 1u)->_Sol[solIndex]->clone().release();
+      NumericVector *weight = _ml_sol->GetSolutionLevel(jg - 1u)->_Sol[solIndex]->clone().release();
+
+      coarseSol->matrix_mult_transpose(*weightedSol, *projection);
+      weight->matrix_mult_transpose(*fineWeight, *projection);
+      for(int i = coarseSol->first_local_index(); i < coarseSol->last_local_index(); i++){
+        double w = (*weight)(i);
+        if( fabs(w) > 1.0e-14 ) coarseSol->set(i, (*coarseSol)(i) / w);
+      }
+      coarseSol->close();
+
+      delete weightedSol;
+      delete fineWeight;
+      delete weight;
+      delete fineSol;
+      fineSol = coarseSol;
+    }
+
+    _restrictedSolution[solIndex] = fineSol;
+    return fineSol;
+  }
+
+  void Writer::ClearOutputSolutions(){
+    for(std::map < unsigned, NumericVector* >::iterator it = _restrictedSolution.begin(); it != _restrictedSolution.end(); it++){
+      delete it->second;
+    }
+    _restrictedSolution.clear();
+  }
+
 
 } //end namespace femus
 
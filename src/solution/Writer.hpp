@@ -22,8 +22,10 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
 #include "ParallelObject.hpp"
 #include "WriterEnum.hpp"
+#include "mpi.h"
 
 namespace femus {
 
@@ -33,7 +35,9 @@ namespace femus {
   class MultiLevelMesh;
   class MultiLevelSolution;
   class SparseMatrix;
+  class NumericVector;
   class Vector;
+  class OutputQueue;
 
 
   class Writer : public ParallelObject {
@@ -65,12 +69,48 @@ namespace femus {
       std::cout<<"Warning this writer type does not have debug printing"<<std::endl;
     };
 
+    virtual void SetAppendedBinaryOutput( bool value ){
+      std::cout<<"Warning this writer type does not have appended binary output"<<std::endl;
+    };
+
+    virtual void SetCompressedOutput( bool value ){
+      std::cout<<"Warning this writer type does not have compressed output"<<std::endl;
+    };
+
+    virtual void SetAsynchronousOutput( const unsigned &maxPendingWrites ){
+      std::cout<<"Warning this writer type does not have asynchronous output"<<std::endl;
+    };
+
     void SetGraphVariable(const std::string &GraphVaraible);
     void UnsetGraphVariable(){ _graph = false;};
 
     void SetSurfaceVariables( std::vector < std::string > &surfaceVariable );
     void UnsetSurfaceVariables(){ _surface = false;};
 
+    /** Write the level "level" (1 = coarse mesh) instead of the finest one: the solution is restricted
+     * from the finest level with the transposed coarse to fine projections */
+    void SetOutputLevel(const unsigned &level);
+
+    /** Write only the elements of the given groups */
+    void SetOutputGroups(const std::vector < unsigned > &groups);
+
+    /** Write only the elements of the given materials */
+    void SetOutputMaterials(const std::vector < unsigned > &materials);
+
+    /** Write only the elements with at least one vertex in the box [xMin, xMax] */
+    void SetOutputBoundingBox(const std::vector < double > &xMin, const std::vector < double > &xMax);
+
+    /** Write only the elements with at least one face on the boundary */
+    void SetOutputBoundaryElements(const bool &value);
+
+    /** Write the whole level again */
+    void UnsetOutputRegion();
+
+    /** Write the parallel output in nFiles files instead of one file for each process: the processes are split in nFiles
+     * groups of consecutive ranks and the first process of each group gathers and writes the pieces of its group (0 = one file for each process).
+     * It has to be called by all the processes */
+    void SetNumberOfOutputFiles(const unsigned &nFiles);
+
   protected:
 
     /** a flag to move the output mesh */
@@ -99,10 +139,74 @@ namespace femus {
     /** map from femus connectivity to vtk-connectivity for paraview visualization */
     static const unsigned FemusToVTKorToXDMFConn[27];
 
+    /** Returns true if the mesh geometry and topology of the given order have to be printed in output_path at time_step:
+     * a static mesh is printed only once and the following outputs refer to the file of the time step _meshTimeStep[index] */
+    bool MeshHasToBeWritten(const std::string &output_path, const unsigned &index, const unsigned &time_step);
+
+    /** the time step of the output that contains the static mesh, for each order */
+    unsigned _meshTimeStep[3];
+
+    /** Write the per-process files in background, with at most maxPendingWrites files in progress;
+     * 0 restores the synchronous output */
+    void StartOutputQueue(const unsigned &maxPendingWrites);
+
+    /** the queue of the background writes, NULL for synchronous output */
+    OutputQueue* _outputQueue;
+
+    /** The solution solIndex to be printed on level ig: the solution itself or, on a coarser output level,
+     * its restriction from the finest level (injection for the Lagrangian solutions, element average for the
+     * discontinuous ones), computed once for each output */
+    NumericVector* GetOutputSolution(const unsigned &ig, const unsigned &solIndex);
+
+    /** Free the restricted solutions of the previous output */
+    void ClearOutputSolutions();
+
+    /** Returns true if the element iel of level ig belongs to the output region */
+    bool ElementIsWritten(const unsigned &ig, const unsigned &iel) const;
+
+    /** a flag for the output of a region of the level */
+    bool _outputRegion;
+
+    /** The number of parallel output files and the file written by the group of this process */
+    unsigned GetNumberOfOutputFiles() const;
+    unsigned GetOutputFileIndex() const;
+
+    /** Collect the pieces of the processes of the group, with nInfo unsigned for each piece, on the first process of the group:
+     * the pieces are gathered in chunks below the int limit of MPI; returns true on the process that writes the file */
+    bool GatherGroupPieces(const std::string &piece, const std::vector < unsigned > &info,
+                           std::vector < std::string > &groupPieces, std::vector < unsigned > &groupInfo);
+
+    /** Write the staged content of filename, in background if the output queue is active (buffer is left empty) */
+    void WriteStagedFile(const std::string &filename, std::string &buffer);
+
+    /** a flag for the aggregated parallel output */
+    bool _aggregatedOutput;
+
 
 
   private:
 
+    /** the output path and the level/dof sizes of the last printed static mesh, for each order */
+    std::string _meshPath[3];
+    std::vector < unsigned > _meshSignature[3];
+
+    /** Forget the printed static meshes, after a change of the output region */
+    void ResetMeshOutput();
+
+    /** the output region */
+    std::vector < unsigned > _outputGroups;
+    std::vector < unsigned > _outputMaterials;
+    std::vector < double > _outputBoxMin;
+    std::vector < double > _outputBoxMax;
+    bool _outputBoundaryElements;
+
+    /** the restricted solutions of the current output */
+    std::map < unsigned, NumericVector* > _restrictedSolution;
+
+    /** the number of output files and the communicator of the group of processes that write the same file */
+    unsigned _outputFiles;
+    MPI_Comm _outputComm;
+
   };
 
 } //end namespace femus
@@ -55,15 +55,26 @@ namespace femus {
 //      _el_pid_name = "PID";
 //     _nd_map_FineToLev = "MAP";
 
-XDMFWriter::XDMFWriter(MultiLevelSolution * ml_sol): Writer(ml_sol) {}
+XDMFWriter::XDMFWriter(MultiLevelSolution * ml_sol): Writer(ml_sol) {
+  _timeSeries = false;
+  SetTimeSeriesChunkSize(16384, 1);
+  SetTimeSeriesCompression(0, false, false);
+}
 
-XDMFWriter::XDMFWriter(MultiLevelMesh * ml_mesh): Writer(ml_mesh) {}
+XDMFWriter::XDMFWriter(MultiLevelMesh * ml_mesh): Writer(ml_mesh) {
+  _timeSeries = false;
+  SetTimeSeriesChunkSize(16384, 1);
+  SetTimeSeriesCompression(0, false, false);
+}
 
 XDMFWriter::~XDMFWriter() {}
 
 void XDMFWriter::write(const std::string output_path, const char order[], const std::vector<std::string>& vars, const unsigned time_step) {
 #ifdef HAVE_HDF5
 
+  ClearOutputSolutions();
+  if( _outputRegion ) std::cout << "Warning the XDMF writer does not have region output, the whole level is printed" << std::endl;
+
   bool print_all = 0;
   for (unsigned ivar=0; ivar < vars.size(); ivar++){
     print_all += !(vars[ivar].compare("All")) + !(vars[ivar].compare("all")) + !(vars[ivar].compare("ALL"));
@@ -105,6 +116,11 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   }
   nel+=_ml_mesh->GetLevel(_gridn-1u)->GetNumberOfElements();
 
+  if( _timeSeries ) {
+    WriteTimeSeries(output_path, order, index_nd, elemtype, type_elem, nvt, nel, vars, print_all, time_step);
+    return;
+  }
+
   unsigned icount;
   unsigned el_dof_number  = _ml_mesh->GetLevel(_gridn-1u)->el->GetNVE(elemtype,index_nd);//ElementDofNumber(ZERO_ELEM,index_nd);
   int * var_conn          = new int [nel*el_dof_number];
@@ -144,6 +160,12 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   hdf5_filename2 << filename_prefix << ".level" << _gridn << "." << time_step << "." << order << ".h5";
 
   hdf5_filename << output_path << "/" <<  hdf5_filename2.str();
+
+  // a static mesh is printed only once: the following outputs refer to the h5 file that contains it
+  bool writeMesh = MeshHasToBeWritten(output_path, index_nd, time_step);
+  std::ostringstream mesh_filename;
+  mesh_filename << filename_prefix << ".level" << _gridn << "." << _meshTimeStep[index_nd] << "." << order << ".h5";
+
   // head ************************************************
   fout<<"<?xml version=\"1.0\" ?>" << std::endl;
   fout<<"<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd []\">"<< std::endl;
@@ -154,33 +176,33 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   fout<<"<Topology Type=\""<< type_elem <<"\" Dimensions=\""<< nel <<"\">"<<std::endl;
   //Connectivity
   fout<<"<DataStructure DataType=\"Int\" Dimensions=\""<< nel << " " << el_dof_number <<"\"" << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/CONNECTIVITY" << std::endl;
+  fout << mesh_filename.str() << ":/CONNECTIVITY" << std::endl;
   fout <<"</DataStructure>" << std::endl;
   fout << "</Topology>" << std::endl;
   fout << "<Geometry Type=\"X_Y_Z\">" << std::endl;
   //Node_X
   fout<<"<DataStructure DataType=\"Float\" Precision=\"8\" Dimensions=\""<< nvt << "  1\"" << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/NODES_X1" << std::endl;
+  fout << mesh_filename.str() << ":/NODES_X1" << std::endl;
   fout <<"</DataStructure>" << std::endl;
   //Node_Y
   fout<<"<DataStructure DataType=\"Float\" Precision=\"8\" Dimensions=\""<< nvt << "  1\"" << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/NODES_X2" << std::endl;
+  fout << mesh_filename.str() << ":/NODES_X2" << std::endl;
   fout <<"</DataStructure>" << std::endl;
   //Node_Z
   fout<<"<DataStructure DataType=\"Float\" Precision=\"8\" Dimensions=\""<< nvt << "  1\"" << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/NODES_X3" << std::endl;
+  fout << mesh_filename.str() << ":/NODES_X3" << std::endl;
   fout <<"</DataStructure>" << std::endl;
   fout <<"</Geometry>" << std::endl;
   //Regions
   fout << "<Attribute Name=\""<< "Regions"<<"\" AttributeType=\"Scalar\" Center=\"Cell\">" << std::endl;
   fout << "<DataItem DataType=\"Int\" Dimensions=\""<< nel << "  1\""  << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/REGIONS" << std::endl;
+  fout << mesh_filename.str() << ":/REGIONS" << std::endl;
   fout << "</DataItem>" << std::endl;
   fout << "</Attribute>" << std::endl;
   //Metis partitions
   fout << "<Attribute Name=\""<< "Domain_partitions"<<"\" AttributeType=\"Scalar\" Center=\"Cell\">" << std::endl;
   fout << "<DataItem DataType=\"Int\" Dimensions=\""<< nel << "  1\""  << "  Format=\"HDF\">" << std::endl;
-  fout << hdf5_filename2.str() << ":/DOMAIN_PARTITIONS" << std::endl;
+  fout << mesh_filename.str() << ":/DOMAIN_PARTITIONS" << std::endl;
   fout << "</DataItem>" << std::endl;
   fout << "</Attribute>" << std::endl;
 
@@ -214,6 +236,16 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   //----------------------------------------------------------------------------------------------------------
 
   //----------------------------------------------------------------------------------------------------------
+#ifdef H5_HAVE_PARALLEL
+  // no gather on process 0: all the processes write their own part of the datasets
+  WriteHDF5Collective(hdf5_filename.str(), index_nd, elemtype, nvt, nel, vars, print_all, writeMesh);
+
+  delete [] var_conn;
+  delete [] var_el_f;
+  delete [] var_nd_f;
+  return;
+#endif
+
   hid_t file_id;
   file_id = H5Fcreate(hdf5_filename.str().c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,H5P_DEFAULT);
   hsize_t dimsf[2];
@@ -221,133 +253,135 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   hid_t dataspace;
   hid_t dataset;
 
-  //-----------------------------------------------------------------------------------------------------------
-  // Printing nodes coordinates
+  if (writeMesh) {
+    //-----------------------------------------------------------------------------------------------------------
+    // Printing nodes coordinates
 
-  for (int i=0; i<3; i++) {
-    for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-      unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
-      NumericVector* mysol = NumericVector::build().release();
+    for (int i=0; i<3; i++) {
+      for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+        unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+        NumericVector* mysol = NumericVector::build().release();
 
-      mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
-      mysol->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
-			 *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,2) );
+        mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
+        mysol->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                           *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,2) );
 
-      vector<double> mysol_ser;
-      mysol->localize_to_one(mysol_ser, 0);
+        vector<double> mysol_ser;
+        mysol->localize_to_one(mysol_ser, 0);
 
-      if(_iproc == 0){
-	for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[ii] = mysol_ser[ii];
+        if(_iproc == 0){
+          for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[ii] = mysol_ser[ii];
+        }
+
+        if (_ml_sol != NULL && _moving_mesh && _ml_mesh->GetLevel(0)->GetDimension() > i) {
+          unsigned varind_DXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          mysol->matrix_mult(*GetOutputSolution(ig, varind_DXDYDZ),
+                             *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,_ml_sol->GetSolutionType(varind_DXDYDZ)));
+          mysol->localize_to_one(mysol_ser, 0);
+          if(_iproc == 0){
+            for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[ii] += mysol_ser[ii];
+          }
+        }
+        delete mysol;
       }
 
-      if (_ml_sol != NULL && _moving_mesh && _ml_mesh->GetLevel(0)->GetDimension() > i) {
-	unsigned varind_DXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
-	mysol->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[varind_DXDYDZ],
-			   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,_ml_sol->GetSolutionType(varind_DXDYDZ)));
-	mysol->localize_to_one(mysol_ser, 0);
-	if(_iproc == 0){
-	  for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[ii] += mysol_ser[ii];
-	}
+      if(_iproc == 0){
+        dimsf[0] = nvt ;  dimsf[1] = 1;
+        std::ostringstream Name; Name << "/NODES_X" << i+1;
+        dataspace = H5Screate_simple(2,dimsf, NULL);
+        dataset   = H5Dcreate(file_id,Name.str().c_str(),H5T_NATIVE_FLOAT,
+                              dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        status = H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL,H5P_DEFAULT,var_nd_f);
+        H5Sclose(dataspace);
+        H5Dclose(dataset);
       }
-      delete mysol;
+    } //end 3d loop
+
+    //-------------------------------------------------------------------------------------------------------------
+
+    //------------------------------------------------------------------------------------------------------
+    //connectivity
+    icount = 0;
+    unsigned offset_conn=0;
+    for ( unsigned ig=_gridr-1u; ig<_gridn; ig++ ) {
+      for ( unsigned iel = 0; iel < _ml_mesh->GetLevel(ig)->GetNumberOfElements(); iel++ ) {
+        if ( ig == _gridn-1u ) {
+          int ndofs = _ml_mesh->GetLevel(ig)->el->GetNVE(elemtype,index_nd);//GetElementDofNumber(iel,index_nd);
+          for (unsigned j = 0; j < ndofs; j++) {
+            unsigned vtk_loc_conn = FemusToVTKorToXDMFConn[j];
+            //unsigned jnode = _ml_mesh->GetLevel(ig)->el->GetElementVertexIndex(iel,vtk_loc_conn)-1u;
+            unsigned jnode_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(vtk_loc_conn,iel,index_nd);
+            var_conn[icount] = offset_conn + jnode_Metis;
+            icount++;
+          }
+        }
+      }
+      offset_conn += _ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
     }
-
-    if(_iproc == 0){
-      dimsf[0] = nvt ;  dimsf[1] = 1;
-      std::ostringstream Name; Name << "/NODES_X" << i+1;
+     if(_iproc == 0){
+      dimsf[0] = nel*el_dof_number ;  dimsf[1] = 1;
       dataspace = H5Screate_simple(2,dimsf, NULL);
-      dataset   = H5Dcreate(file_id,Name.str().c_str(),H5T_NATIVE_FLOAT,
-			    dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-      status = H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL,H5P_DEFAULT,var_nd_f);
+      dataset   = H5Dcreate(file_id,"/CONNECTIVITY",H5T_NATIVE_INT,
+                            dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,&var_conn[0]);
       H5Sclose(dataspace);
       H5Dclose(dataset);
-    }
-  } //end 3d loop
-
-  //-------------------------------------------------------------------------------------------------------------
-
-  //------------------------------------------------------------------------------------------------------
-  //connectivity
-  icount = 0;
-  unsigned offset_conn=0;
-  for ( unsigned ig=_gridr-1u; ig<_gridn; ig++ ) {
-    for ( unsigned iel = 0; iel < _ml_mesh->GetLevel(ig)->GetNumberOfElements(); iel++ ) {
-      if ( ig == _gridn-1u ) {
-	int ndofs = _ml_mesh->GetLevel(ig)->el->GetNVE(elemtype,index_nd);//GetElementDofNumber(iel,index_nd);
-        for (unsigned j = 0; j < ndofs; j++) {
-	  unsigned vtk_loc_conn = FemusToVTKorToXDMFConn[j];
-	  //unsigned jnode = _ml_mesh->GetLevel(ig)->el->GetElementVertexIndex(iel,vtk_loc_conn)-1u;
-	  unsigned jnode_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(vtk_loc_conn,iel,index_nd);
-	  var_conn[icount] = offset_conn + jnode_Metis;
-	  icount++;
-	}
-      }
-    }
-    offset_conn += _ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
-  }
-   if(_iproc == 0){
-    dimsf[0] = nel*el_dof_number ;  dimsf[1] = 1;
-    dataspace = H5Screate_simple(2,dimsf, NULL);
-    dataset   = H5Dcreate(file_id,"/CONNECTIVITY",H5T_NATIVE_INT,
-			  dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,&var_conn[0]);
-    H5Sclose(dataspace);
-    H5Dclose(dataset);
-   }
-  //------------------------------------------------------------------------------------------------------
-
-
-  //-------------------------------------------------------------------------------------------------------
-//   // print regions
-//
-//   icount=0;
-//   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
-//
-//     for (unsigned ii=0; ii<_ml_mesh->GetLevel(ig)->GetNumberOfElements(); ii++) {
-//       if (ig==_gridn-1u ) {
-// 	unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0,ii,3);
-// 	var_conn[icount] = _ml_mesh->GetLevel(ig)->el->GetElementGroup(ii);
-// 	icount++;
-//       }
-//     }
-//   }
-//   if(_iproc == 0){
-//     dimsf[0] = nel;  dimsf[1] = 1;
-//     dataspace = H5Screate_simple(2,dimsf, NULL);
-//     dataset   = H5Dcreate(file_id,"/REGIONS",H5T_NATIVE_INT,
-// 			  dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-//     status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,var_conn);
-//     H5Sclose(dataspace);
-//     H5Dclose(dataset);
-//   }
-//
-//   // end print regions
-  //-------------------------------------------------------------------------------------------------------
-
-  //-------------------------------------------------------------------------------------------------------
-  // print partitioning
-  icount=0;
-  for (unsigned ig=_gridr-1u; ig < _gridn; ig++) {
-    for(int isdom = 0; isdom < _nprocs; isdom++){
-      for( unsigned ii = _ml_mesh->GetLevel(ig)->_elementOffset[isdom];
-        ii < _ml_mesh->GetLevel(ig)->_elementOffset[isdom+1]; ii++){
-        if ( ig == _gridn-1u) {
-          var_proc[icount] = isdom;
-          icount++;
+     }
+    //------------------------------------------------------------------------------------------------------
+
+
+    //-------------------------------------------------------------------------------------------------------
+  //   // print regions
+  //
+  //   icount=0;
+  //   for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+  //
+  //     for (unsigned ii=0; ii<_ml_mesh->GetLevel(ig)->GetNumberOfElements(); ii++) {
+  //       if (ig==_gridn-1u ) {
+  // 	unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0,ii,3);
+  // 	var_conn[icount] = _ml_mesh->GetLevel(ig)->el->GetElementGroup(ii);
+  // 	icount++;
+  //       }
+  //     }
+  //   }
+  //   if(_iproc == 0){
+  //     dimsf[0] = nel;  dimsf[1] = 1;
+  //     dataspace = H5Screate_simple(2,dimsf, NULL);
+  //     dataset   = H5Dcreate(file_id,"/REGIONS",H5T_NATIVE_INT,
+  // 			  dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  //     status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,var_conn);
+  //     H5Sclose(dataspace);
+  //     H5Dclose(dataset);
+  //   }
+  //
+  //   // end print regions
+    //-------------------------------------------------------------------------------------------------------
+
+    //-------------------------------------------------------------------------------------------------------
+    // print partitioning
+    icount=0;
+    for (unsigned ig=_gridr-1u; ig < _gridn; ig++) {
+      for(int isdom = 0; isdom < _nprocs; isdom++){
+        for( unsigned ii = _ml_mesh->GetLevel(ig)->_elementOffset[isdom];
+          ii < _ml_mesh->GetLevel(ig)->_elementOffset[isdom+1]; ii++){
+          if ( ig == _gridn-1u) {
+            var_proc[icount] = isdom;
+            icount++;
+          }
         }
       }
     }
+    if(_iproc == 0){
+      dimsf[0] = nel;  dimsf[1] = 1;
+      dataspace = H5Screate_simple(2,dimsf, NULL);
+      dataset   = H5Dcreate(file_id,"/DOMAIN_PARTITIONS",H5T_NATIVE_INT,
+                            dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,&var_proc[0]);
+      H5Sclose(dataspace);
+      H5Dclose(dataset);
+    }
+    // end print partitioning
   }
-  if(_iproc == 0){
-    dimsf[0] = nel;  dimsf[1] = 1;
-    dataspace = H5Screate_simple(2,dimsf, NULL);
-    dataset   = H5Dcreate(file_id,"/DOMAIN_PARTITIONS",H5T_NATIVE_INT,
-			  dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    status   = H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,H5P_DEFAULT,&var_proc[0]);
-    H5Sclose(dataspace);
-    H5Dclose(dataset);
-  }
-  // end print partitioning
   //-------------------------------------------------------------------------------------------------------
 
   if (_ml_sol != NULL)  {
@@ -359,11 +393,11 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
       icount=0;
       for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
 	unsigned nel_ig = _ml_mesh->GetLevel(ig)->GetNumberOfElements();
-	unsigned sol_size = _ml_sol->GetSolutionLevel(ig)->_Sol[indx]->size();
+	unsigned sol_size = GetOutputSolution(ig, indx)->size();
 	vector < double > mysol_ser;
 	for (unsigned ii=0; ii<nel_ig; ii++) {
 	  if (ig==_gridn-1u ) {
-	    _ml_sol->GetSolutionLevel(ig)->_Sol[indx]->localize_to_one(mysol_ser, 0);
+	    GetOutputSolution(ig, indx)->localize_to_one(mysol_ser, 0);
 	    unsigned iel_Metis = _ml_mesh->GetLevel(ig)->GetSolutionDof(0,ii,_ml_sol->GetSolutionType(indx));
 	    var_el_f[icount]=mysol_ser[iel_Metis];
 	    icount++;
@@ -391,7 +425,7 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
         unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
         NumericVector* mysol = NumericVector::build().release();
 	mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
-	mysol->matrix_mult(*_ml_sol->GetSolutionLevel(ig)->_Sol[indx],
+	mysol->matrix_mult(*GetOutputSolution(ig, indx),
 			   *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd, _ml_sol->GetSolutionType(indx)) );
         vector < double > mysol_ser;
 	mysol->localize_to_one(mysol_ser, 0);
@@ -426,6 +460,510 @@ void XDMFWriter::write(const std::string output_path, const char order[], const
   return;
 }
 
+#if defined(HAVE_HDF5) && defined(H5_HAVE_PARALLEL)
+
+/**
+ * Create the dataset name of globalSize rows and write to it the union of the blocks [offset[i], offset[i]+count[i]),
+ * stored one after the other in data, with a single collective call
+ **/
+static void WriteCollectiveHyperslabs(hid_t file_id, const std::string &name, hid_t type, const hsize_t &globalSize,
+                                      const std::vector < hsize_t > &offset, const std::vector < hsize_t > &count, const void *data) {
+
+  hsize_t dimsf[2] = {globalSize, 1};
+  hid_t filespace = H5Screate_simple(2, dimsf, NULL);
+  hid_t dataset = H5Dcreate(file_id, name.c_str(), type, filespace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+  H5Sselect_none(filespace);
+  hsize_t localSize = 0;
+  for (unsigned i = 0; i < offset.size(); i++) {
+    if (count[i] > 0) {
+      hsize_t start[2] = {offset[i], 0};
+      hsize_t block[2] = {count[i], 1};
+      H5Sselect_hyperslab(filespace, H5S_SELECT_OR, start, NULL, block, NULL);
+      localSize += count[i];
+    }
+  }
+
+  hsize_t dimsm[2] = {localSize, 1};
+  hid_t memspace = H5Screate_simple(2, dimsm, NULL);
+  if (localSize == 0) H5Sselect_none(memspace);
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+  H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+  H5Dwrite(dataset, type, memspace, filespace, plist_id, data);
+
+  H5Pclose(plist_id);
+  H5Sclose(memspace);
+  H5Sclose(filespace);
+  H5Dclose(dataset);
+}
+
+#endif
+
+void XDMFWriter::WriteHDF5Collective(const std::string &hdf5_filename, const unsigned &index_nd, const unsigned &elemtype,
+                                     const unsigned &nvt, const unsigned &nel, const std::vector < std::string > &vars, const bool &print_all,
+                                     const bool &writeMesh) {
+#if defined(HAVE_HDF5) && defined(H5_HAVE_PARALLEL)
+
+  hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_mpio(plist_id, MPI_COMM_WORLD, MPI_INFO_NULL);
+  hid_t file_id = H5Fcreate(hdf5_filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+  H5Pclose(plist_id);
+
+  Mesh* mshFine = _ml_mesh->GetLevel(_gridn-1u);
+  unsigned el_dof_number = mshFine->el->GetNVE(elemtype,index_nd);
+
+  // the nodes of the printed levels are stored one after the other, each process owns one block for each level
+  std::vector < hsize_t > nodeOffset;
+  std::vector < hsize_t > nodeCount;
+  unsigned levelOffset = 0;
+  for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+    Mesh* msh = _ml_mesh->GetLevel(ig);
+    nodeOffset.push_back(levelOffset + msh->_dofOffset[index_nd][_iproc]);
+    nodeCount.push_back(msh->_ownSize[index_nd][_iproc]);
+    levelOffset += msh->_dofOffset[index_nd][_nprocs];
+  }
+  unsigned offset_conn = levelOffset - mshFine->_dofOffset[index_nd][_nprocs];
+
+  // only the elements of the finest level are printed
+  unsigned elementStart = mshFine->_elementOffset[_iproc];
+  unsigned elementEnd = mshFine->_elementOffset[_iproc+1];
+  std::vector < hsize_t > elementOffset(1, elementStart);
+  std::vector < hsize_t > elementCount(1, elementEnd - elementStart);
+  std::vector < hsize_t > connOffset(1, elementStart * el_dof_number);
+  std::vector < hsize_t > connCount(1, (elementEnd - elementStart) * el_dof_number);
+
+  std::vector < float > var_nd_f;
+  var_nd_f.reserve(levelOffset);
+  std::vector < float > var_el_f(elementEnd - elementStart);
+
+  if (writeMesh) {
+    //-------------------------------------------------------------------------------------------------------
+    // Printing nodes coordinates
+    for (int i=0; i<3; i++) {
+      var_nd_f.resize(0);
+      for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+        unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+        NumericVector* mysol = NumericVector::build().release();
+        mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
+        mysol->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                           *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,2) );
+
+        unsigned levelStart = var_nd_f.size();
+        for (int ii=mysol->first_local_index(); ii<mysol->last_local_index(); ii++) var_nd_f.push_back((*mysol)(ii));
+
+        if (_ml_sol != NULL && _moving_mesh && _ml_mesh->GetLevel(0)->GetDimension() > i) {
+          unsigned varind_DXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          mysol->matrix_mult(*GetOutputSolution(ig, varind_DXDYDZ),
+                             *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,_ml_sol->GetSolutionType(varind_DXDYDZ)));
+          for (int ii=mysol->first_local_index(); ii<mysol->last_local_index(); ii++) {
+            var_nd_f[levelStart + ii - mysol->first_local_index()] += (*mysol)(ii);
+          }
+        }
+        delete mysol;
+      }
+      std::ostringstream Name; Name << "/NODES_X" << i+1;
+      WriteCollectiveHyperslabs(file_id, Name.str(), H5T_NATIVE_FLOAT, nvt, nodeOffset, nodeCount, (var_nd_f.size() > 0) ? &var_nd_f[0] : NULL);
+    }
+
+    //-------------------------------------------------------------------------------------------------------
+    // connectivity
+    std::vector < int > var_conn((elementEnd - elementStart) * el_dof_number);
+    unsigned icount = 0;
+    for (unsigned iel = elementStart; iel < elementEnd; iel++) {
+      for (unsigned j = 0; j < el_dof_number; j++) {
+        unsigned vtk_loc_conn = FemusToVTKorToXDMFConn[j];
+        var_conn[icount] = offset_conn + mshFine->GetSolutionDof(vtk_loc_conn,iel,index_nd);
+        icount++;
+      }
+    }
+    WriteCollectiveHyperslabs(file_id, "/CONNECTIVITY", H5T_NATIVE_INT, nel*el_dof_number, connOffset, connCount, (icount > 0) ? &var_conn[0] : NULL);
+
+    //-------------------------------------------------------------------------------------------------------
+    // partitioning
+    std::vector < int > var_proc(elementEnd - elementStart, _iproc);
+    WriteCollectiveHyperslabs(file_id, "/DOMAIN_PARTITIONS", H5T_NATIVE_INT, nel, elementOffset, elementCount, (var_proc.size() > 0) ? &var_proc[0] : NULL);
+  }
+
+  if (_ml_sol != NULL) {
+    for (unsigned i=0; i<(1-print_all)*vars.size()+print_all*_ml_sol->GetSolutionSize(); i++) {
+      unsigned indx=(print_all==0)?_ml_sol->GetIndex(vars[i].c_str()):i;
+      unsigned solType = _ml_sol->GetSolutionType(indx);
+      if (solType >= 3) {
+        // element variables
+        NumericVector* sol = GetOutputSolution(_gridn-1u, indx);
+        for (unsigned iel = elementStart; iel < elementEnd; iel++) {
+          var_el_f[iel - elementStart] = (*sol)(mshFine->GetSolutionDof(0,iel,solType));
+        }
+        WriteCollectiveHyperslabs(file_id, _ml_sol->GetSolutionName(indx), H5T_NATIVE_FLOAT, nel, elementOffset, elementCount, (var_el_f.size() > 0) ? &var_el_f[0] : NULL);
+      }
+      else {
+        // node variables
+        var_nd_f.resize(0);
+        for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+          unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+          NumericVector* mysol = NumericVector::build().release();
+          mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
+          mysol->matrix_mult(*GetOutputSolution(ig, indx),
+                             *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd, solType) );
+          for (int ii=mysol->first_local_index(); ii<mysol->last_local_index(); ii++) var_nd_f.push_back((*mysol)(ii));
+          delete mysol;
+        }
+        WriteCollectiveHyperslabs(file_id, _ml_sol->GetSolutionName(indx), H5T_NATIVE_FLOAT, nvt, nodeOffset, nodeCount, (var_nd_f.size() > 0) ? &var_nd_f[0] : NULL);
+      }
+    }
+  }
+
+  H5Fclose(file_id);
+
+#endif
+}
+
+#ifdef HAVE_HDF5
+
+/**
+ * Write the row step of the time series dataset name, of size values of the given type for each time step. The dataset is created
+ * extendable along the time direction, chunked with timeChunk x spaceChunk values and compressed with the given filters
+ **/
+static void AppendTimeStep(hid_t file_id, const std::string &name, const hsize_t &size, const hsize_t &step, const void *data,
+                           const unsigned &spaceChunk, const unsigned &timeChunk, const unsigned &gzipLevel,
+                           const bool &shuffle, const bool &szip, hid_t type = H5T_NATIVE_FLOAT) {
+
+  hsize_t dims[2] = {step + 1u, size};
+  hid_t dataset;
+  if( H5Lexists(file_id, name.c_str(), H5P_DEFAULT) > 0 ) {
+    dataset = H5Dopen(file_id, name.c_str(), H5P_DEFAULT);
+    H5Dset_extent(dataset, dims);
+  }
+  else {
+    hsize_t maxdims[2] = {H5S_UNLIMITED, size};
+    hsize_t chunk[2] = {timeChunk, ( spaceChunk < size ) ? spaceChunk : size};
+    if( chunk[1] == 0 ) chunk[1] = 1;
+    hid_t dataspace = H5Screate_simple(2, dims, maxdims);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 2, chunk);
+    if( shuffle ) H5Pset_shuffle(dcpl);
+    if( szip && H5Zfilter_avail(H5Z_FILTER_SZIP) > 0 ) H5Pset_szip(dcpl, H5_SZIP_NN_OPTION_MASK, 16);
+    else if( gzipLevel > 0 ) H5Pset_deflate(dcpl, gzipLevel);
+    dataset = H5Dcreate(file_id, name.c_str(), type, dataspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(dataspace);
+  }
+
+  hid_t filespace = H5Dget_space(dataset);
+  hsize_t start[2] = {step, 0};
+  hsize_t count[2] = {1, size};
+  H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, NULL, count, NULL);
+  hid_t memspace = H5Screate_simple(2, count, NULL);
+  H5Dwrite(dataset, type, memspace, filespace, H5P_DEFAULT, data);
+  H5Sclose(memspace);
+  H5Sclose(filespace);
+  H5Dclose(dataset);
+}
+
+/** Size of the dimension dim of the dataset name, 0 if the dataset does not exist */
+static hsize_t GetDatasetDimension(hid_t file_id, const std::string &name, const unsigned &dim) {
+  if( H5Lexists(file_id, name.c_str(), H5P_DEFAULT) <= 0 ) return 0;
+  hid_t dataset = H5Dopen(file_id, name.c_str(), H5P_DEFAULT);
+  hid_t dataspace = H5Dget_space(dataset);
+  hsize_t dims[2] = {0, 0};
+  H5Sget_simple_extent_dims(dataspace, dims, NULL);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+  return dims[dim];
+}
+
+/**
+ * Read the time steps of an existing time series file, if its mesh has nvt nodes and connectivitySize connectivity entries.
+ * Returns an empty vector if the file does not exist or belongs to a different mesh
+ **/
+static void ReadTimeSeriesSteps(const std::string &filename, const unsigned &nvt, const unsigned &connectivitySize,
+                                const bool &movingMesh, std::vector < unsigned > &steps) {
+  steps.resize(0);
+  std::ifstream test(filename.c_str());
+  if( !test.good() ) return;
+  test.close();
+
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if( file_id < 0 ) return;
+
+  hsize_t nsteps = GetDatasetDimension(file_id, "/TIME_STEPS", 0);
+  if( nsteps > 0 &&
+      GetDatasetDimension(file_id, "/CONNECTIVITY", 0) == connectivitySize &&
+      GetDatasetDimension(file_id, "/NODES_X1", ( movingMesh ) ? 1 : 0) == nvt ) {
+    steps.resize(nsteps);
+    hid_t dataset = H5Dopen(file_id, "/TIME_STEPS", H5P_DEFAULT);
+    H5Dread(dataset, H5T_NATIVE_UINT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &steps[0]);
+    H5Dclose(dataset);
+  }
+  H5Fclose(file_id);
+}
+
+/** Write the dataset name of size values, that does not change in the time series */
+static void WriteStaticDataset(hid_t file_id, const std::string &name, hid_t type, const hsize_t &size, const void *data) {
+  hsize_t dimsf[2] = {size, 1};
+  hid_t dataspace = H5Screate_simple(2, dimsf, NULL);
+  hid_t dataset = H5Dcreate(file_id, name.c_str(), type, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+}
+
+/** Print the XDMF hyperslab selecting the row step of the time series dataset */
+static void PrintTimeStepDataItem(std::ostream &fout, const std::string &dataset, const unsigned &step, const unsigned &nsteps, const unsigned &size) {
+  fout << "<DataItem ItemType=\"HyperSlab\" Dimensions=\"1 " << size << "\" Type=\"HyperSlab\">" << std::endl;
+  fout << "<DataItem Dimensions=\"3 2\" Format=\"XML\">" << step << " 0 1 1 1 " << size << "</DataItem>" << std::endl;
+  fout << "<DataItem DataType=\"Float\" Precision=\"4\" Dimensions=\"" << nsteps << " " << size << "\" Format=\"HDF\">" << std::endl;
+  fout << dataset << std::endl;
+  fout << "</DataItem>" << std::endl;
+  fout << "</DataItem>" << std::endl;
+}
+
+#endif
+
+void XDMFWriter::SetTimeSeriesChunkSize(const unsigned &spaceChunk, const unsigned &timeChunk) {
+  _timeSeriesSpaceChunk = ( spaceChunk > 0 ) ? spaceChunk : 1;
+  _timeSeriesTimeChunk = ( timeChunk > 0 ) ? timeChunk : 1;
+}
+
+void XDMFWriter::SetTimeSeriesCompression(const unsigned &gzipLevel, const bool &shuffle, const bool &szip) {
+  _gzipLevel = ( gzipLevel < 9 ) ? gzipLevel : 9;
+  _shuffle = shuffle;
+  _szip = szip;
+}
+
+void XDMFWriter::WriteTimeSeries(const std::string &output_path, const char order[], const unsigned &index_nd, const unsigned &elemtype,
+                                 const std::string &type_elem, const unsigned &nvt, const unsigned &nel,
+                                 const std::vector < std::string > &vars, const bool &print_all, const unsigned &time_step) {
+#ifdef HAVE_HDF5
+
+  std::string filename_prefix;
+  if( _ml_sol != NULL ) filename_prefix = "sol";
+  else filename_prefix = "mesh";
+
+  std::ostringstream hdf5_filename2;
+  hdf5_filename2 << filename_prefix << ".level" << _gridn << "." << order << ".series.h5";
+  std::ostringstream hdf5_filename;
+  hdf5_filename << output_path << "/" << hdf5_filename2.str();
+  std::ostringstream xdmf_filename;
+  xdmf_filename << output_path << "/" << filename_prefix << ".level" << _gridn << "." << order << ".series.xmf";
+
+  bool movingMesh = ( _ml_sol != NULL && _moving_mesh );
+  unsigned el_dof_number = _ml_mesh->GetLevel(_gridn-1u)->el->GetNVE(elemtype,index_nd);
+
+  // a run restarted with a new writer continues the series of the file, from the steps before time_step
+  std::vector < unsigned > &steps = _timeSeriesSteps[index_nd];
+  if( steps.size() == 0 && time_step > 0 ) {
+    std::vector < unsigned > fileSteps;
+    if( _iproc == 0 ) ReadTimeSeriesSteps(hdf5_filename.str(), nvt, nel*el_dof_number, movingMesh, fileSteps);
+    unsigned nFileSteps = fileSteps.size();
+    MPI_Bcast(&nFileSteps, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    fileSteps.resize(nFileSteps);
+    if( nFileSteps > 0 ) MPI_Bcast(&fileSteps[0], nFileSteps, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+
+    for (unsigned k = 0; k < nFileSteps && fileSteps[k] < time_step; k++) steps.push_back(fileSteps[k]);
+    // the steps after the restart are overwritten, the datasets are shrunk to the rows of the series
+    _timeSeriesNvt[index_nd] = nvt;
+    _timeSeriesNel[index_nd] = nel;
+  }
+
+  // a new series starts at the first call and when the time step does not increase
+  bool newSeries = ( steps.size() == 0 || time_step <= steps.back() );
+  if( newSeries ) {
+    steps.resize(0);
+    _timeSeriesNvt[index_nd] = nvt;
+    _timeSeriesNel[index_nd] = nel;
+  }
+  else if( _timeSeriesNvt[index_nd] != nvt || _timeSeriesNel[index_nd] != nel ) {
+    std::cout << "XDMF-Writer error: the mesh of a time series cannot change between the time steps" << std::endl;
+    abort();
+  }
+  unsigned step = steps.size();
+  steps.push_back(time_step);
+
+  hid_t file_id = 0;
+  if( _iproc == 0 ) {
+    if( newSeries ) file_id = H5Fcreate(hdf5_filename.str().c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    else file_id = H5Fopen(hdf5_filename.str().c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+    if( file_id < 0 ) {
+      std::cout << std::endl << " The output file "<< hdf5_filename.str() <<" cannot be opened.\n";
+      abort();
+    }
+    std::cout << std::endl << " The output is appended to file " << hdf5_filename.str() << " in XDMF-HDF5 format" << std::endl;
+  }
+
+  std::vector < float > var_nd_f(nvt + 1u);
+  std::vector < float > var_el_f(nel + 1u);
+
+  //-------------------------------------------------------------------------------------------------------
+  // nodes coordinates: written once, or at each time step for a moving mesh
+  if( newSeries || movingMesh ) {
+    for (int i=0; i<3; i++) {
+      unsigned offset_nvt = 0;
+      for (unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+        unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+        NumericVector* mysol = NumericVector::build().release();
+        mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
+        mysol->matrix_mult(*_ml_mesh->GetLevel(ig)->_topology->_Sol[i],
+                           *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,2) );
+        vector<double> mysol_ser;
+        mysol->localize_to_one(mysol_ser, 0);
+        if(_iproc == 0){
+          for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[offset_nvt + ii] = mysol_ser[ii];
+        }
+        if (movingMesh && _ml_mesh->GetLevel(0)->GetDimension() > i) {
+          unsigned varind_DXDYDZ=_ml_sol->GetIndex(_moving_vars[i].c_str());
+          mysol->matrix_mult(*GetOutputSolution(ig, varind_DXDYDZ),
+                             *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd,_ml_sol->GetSolutionType(varind_DXDYDZ)));
+          mysol->localize_to_one(mysol_ser, 0);
+          if(_iproc == 0){
+            for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[offset_nvt + ii] += mysol_ser[ii];
+          }
+        }
+        delete mysol;
+        offset_nvt += nvt_ig;
+      }
+      if(_iproc == 0){
+        std::ostringstream Name; Name << "/NODES_X" << i+1;
+        if( movingMesh ) AppendTimeStep(file_id, Name.str(), nvt, step, &var_nd_f[0], _timeSeriesSpaceChunk, _timeSeriesTimeChunk, _gzipLevel, _shuffle, _szip);
+        else WriteStaticDataset(file_id, Name.str(), H5T_NATIVE_FLOAT, nvt, &var_nd_f[0]);
+      }
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------------------
+  // connectivity and partitioning of the finest level: written once
+  if( newSeries ) {
+    Mesh* mshFine = _ml_mesh->GetLevel(_gridn-1u);
+    unsigned offset_conn = 0;
+    for (unsigned ig=_gridr-1u; ig<_gridn-1u; ig++) offset_conn += _ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+
+    std::vector < int > var_conn(nel*el_dof_number + 1u);
+    std::vector < int > var_proc(nel + 1u);
+    unsigned icount = 0;
+    for (unsigned iel = 0; iel < mshFine->GetNumberOfElements(); iel++) {
+      for (unsigned j = 0; j < el_dof_number; j++) {
+        var_conn[icount] = offset_conn + mshFine->GetSolutionDof(FemusToVTKorToXDMFConn[j],iel,index_nd);
+        icount++;
+      }
+    }
+    icount = 0;
+    for (int isdom = 0; isdom < _nprocs; isdom++) {
+      for (unsigned iel = mshFine->_elementOffset[isdom]; iel < mshFine->_elementOffset[isdom+1]; iel++) {
+        var_proc[icount] = isdom;
+        icount++;
+      }
+    }
+    if(_iproc == 0){
+      WriteStaticDataset(file_id, "/CONNECTIVITY", H5T_NATIVE_INT, nel*el_dof_number, &var_conn[0]);
+      WriteStaticDataset(file_id, "/DOMAIN_PARTITIONS", H5T_NATIVE_INT, nel, &var_proc[0]);
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------------------
+  // element and node variables: one row for each time step
+  std::vector < unsigned > printedVars;
+  if (_ml_sol != NULL) {
+    for (unsigned i=0; i<(1-print_all)*vars.size()+print_all*_ml_sol->GetSolutionSize(); i++) {
+      unsigned indx=(print_all==0)?_ml_sol->GetIndex(vars[i].c_str()):i;
+      unsigned solType = _ml_sol->GetSolutionType(indx);
+      printedVars.push_back(indx);
+      if (solType >= 3) {
+        vector < double > mysol_ser;
+        GetOutputSolution(_gridn-1u, indx)->localize_to_one(mysol_ser, 0);
+        if(_iproc == 0){
+          for (unsigned iel=0; iel<_ml_mesh->GetLevel(_gridn-1u)->GetNumberOfElements(); iel++) {
+            var_el_f[iel] = mysol_ser[_ml_mesh->GetLevel(_gridn-1u)->GetSolutionDof(0,iel,solType)];
+          }
+          AppendTimeStep(file_id, _ml_sol->GetSolutionName(indx), nel, step, &var_el_f[0], _timeSeriesSpaceChunk, _timeSeriesTimeChunk, _gzipLevel, _shuffle, _szip);
+        }
+      }
+      else {
+        unsigned offset_nvt = 0;
+        for(unsigned ig=_gridr-1u; ig<_gridn; ig++) {
+          unsigned nvt_ig=_ml_mesh->GetLevel(ig)->_dofOffset[index_nd][_nprocs];
+          NumericVector* mysol = NumericVector::build().release();
+          mysol->init(nvt_ig,_ml_mesh->GetLevel(ig)->_ownSize[index_nd][_iproc],true,AUTOMATIC);
+          mysol->matrix_mult(*GetOutputSolution(ig, indx),
+                             *_ml_mesh->GetLevel(ig)->GetQitoQjProjection(index_nd, solType) );
+          vector < double > mysol_ser;
+          mysol->localize_to_one(mysol_ser, 0);
+          if(_iproc == 0){
+            for (unsigned ii=0; ii<nvt_ig; ii++) var_nd_f[offset_nvt + ii] = mysol_ser[ii];
+          }
+          delete mysol;
+          offset_nvt += nvt_ig;
+        }
+        if(_iproc == 0){
+          AppendTimeStep(file_id, _ml_sol->GetSolutionName(indx), nvt, step, &var_nd_f[0], _timeSeriesSpaceChunk, _timeSeriesTimeChunk, _gzipLevel, _shuffle, _szip);
+        }
+      }
+    }
+  }
+
+  if( _iproc != 0 ) return;
+
+  // the time step of each row, to continue the series after a restart
+  AppendTimeStep(file_id, "/TIME_STEPS", 1, step, &time_step, 1, _timeSeriesTimeChunk, 0, false, false, H5T_NATIVE_UINT);
+
+  H5Fclose(file_id);
+
+  //-------------------------------------------------------------------------------------------------------
+  // the temporal collection of the time steps of the series: it is written again at each time step, since the
+  // HDF DataItems of all the grids declare the current number of rows of the datasets
+  std::ofstream fout(xdmf_filename.str().c_str());
+  if (!fout.is_open()) {
+    std::cout << std::endl << " The output file "<< xdmf_filename.str() <<" cannot be opened.\n";
+    abort();
+  }
+  fout << "<?xml version=\"1.0\" ?>" << std::endl;
+  fout << "<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd []\">" << std::endl;
+  fout << "<Xdmf>" << std::endl;
+  fout << "<Domain>" << std::endl;
+  fout << "<Grid Name=\"Mesh\" GridType=\"Collection\" CollectionType=\"Temporal\">" << std::endl;
+
+  unsigned nsteps = steps.size();
+  for (unsigned k = 0; k < nsteps; k++) {
+    fout << "<Grid Name=\"Mesh\">" << std::endl;
+    fout << "<Time Value =\"" << steps[k] << "\" />" << std::endl;
+    fout << "<Topology Type=\"" << type_elem << "\" Dimensions=\"" << nel << "\">" << std::endl;
+    fout << "<DataStructure DataType=\"Int\" Dimensions=\"" << nel << " " << el_dof_number << "\"" << "  Format=\"HDF\">" << std::endl;
+    fout << hdf5_filename2.str() << ":/CONNECTIVITY" << std::endl;
+    fout << "</DataStructure>" << std::endl;
+    fout << "</Topology>" << std::endl;
+    fout << "<Geometry Type=\"X_Y_Z\">" << std::endl;
+    for (int i = 0; i < 3; i++) {
+      std::ostringstream Name; Name << hdf5_filename2.str() << ":/NODES_X" << i+1;
+      if( movingMesh ) PrintTimeStepDataItem(fout, Name.str(), k, nsteps, nvt);
+      else {
+        fout << "<DataStructure DataType=\"Float\" Precision=\"4\" Dimensions=\"" << nvt << "  1\"" << "  Format=\"HDF\">" << std::endl;
+        fout << Name.str() << std::endl;
+        fout << "</DataStructure>" << std::endl;
+      }
+    }
+    fout << "</Geometry>" << std::endl;
+    fout << "<Attribute Name=\"" << "Domain_partitions" << "\" AttributeType=\"Scalar\" Center=\"Cell\">" << std::endl;
+    fout << "<DataItem DataType=\"Int\" Dimensions=\"" << nel << "  1\"" << "  Format=\"HDF\">" << std::endl;
+    fout << hdf5_filename2.str() << ":/DOMAIN_PARTITIONS" << std::endl;
+    fout << "</DataItem>" << std::endl;
+    fout << "</Attribute>" << std::endl;
+    for (unsigned i = 0; i < printedVars.size(); i++) {
+      bool cellVariable = ( _ml_sol->GetSolutionType(printedVars[i]) >= 3 );
+      fout << "<Attribute Name=\"" << _ml_sol->GetSolutionName(printedVars[i]) << "\" AttributeType=\"Scalar\" Center=\""
+           << ( ( cellVariable ) ? "Cell" : "Node" ) << "\">" << std::endl;
+      PrintTimeStepDataItem(fout, hdf5_filename2.str() + ":/" + _ml_sol->GetSolutionName(printedVars[i]), k, nsteps, ( cellVariable ) ? nel : nvt);
+      fout << "</Attribute>" << std::endl;
+    }
+    fout << "</Grid>" << std::endl;
+  }
+  fout << "</Grid>" << std::endl;
+  fout << "</Domain>" << std::endl;
+  fout << "</Xdmf>" << std::endl;
+  fout.close();
+
+#endif
+}
+
 void XDMFWriter::write_solution_wrapper(const std::string output_path, const char type[]) const {
 
 #ifdef HAVE_HDF5
@@ -52,6 +52,17 @@ public:
       write(output_path, order, vars, time_step);
     };
     
+    /** Append the time steps to extendable datasets of a single h5 file, indexed by a single temporal collection xmf file.
+        A new writer called with time_step > 0 continues the series already in the file, e.g. after a restart */
+    void SetTimeSeriesOutput(const bool &value){ _timeSeries = value; };
+
+    /** Chunks of spaceChunk values times timeChunk time steps: timeChunk = 1 favors writing and reading whole time steps,
+        larger values favor reading the time history of a few dofs */
+    void SetTimeSeriesChunkSize(const unsigned &spaceChunk, const unsigned &timeChunk = 1);
+
+    /** Compression of the time series: gzip level (0 = no compression), shuffle filter, szip in place of gzip when available */
+    void SetTimeSeriesCompression(const unsigned &gzipLevel, const bool &shuffle = true, const bool &szip = false);
+
     /** write a wrapper file for paraview to open all the files of an history together */
     void write_solution_wrapper(const std::string output_path, const char type[]) const;
 
@@ -145,7 +156,30 @@ public:
  static void ReadSol(const std::string output_path, const uint t_step, double& time_out, const MultiLevelProblem & ml_prob);  ///< Read solution //TODO must be updated, not implemented
 
 private:
+
+   /** Write the fields of write() collectively with parallel HDF5: each process writes its owned nodes and elements
+       as hyperslabs of the shared datasets. The mesh datasets are written only if writeMesh is true */
+   void WriteHDF5Collective(const std::string &hdf5_filename, const unsigned &index_nd, const unsigned &elemtype,
+                            const unsigned &nvt, const unsigned &nel, const std::vector < std::string > &vars, const bool &print_all,
+                            const bool &writeMesh);
   
+   /** Append the fields of write() to the time series files, gathered on process 0 */
+   void WriteTimeSeries(const std::string &output_path, const char order[], const unsigned &index_nd, const unsigned &elemtype,
+                        const std::string &type_elem, const unsigned &nvt, const unsigned &nel,
+                        const std::vector < std::string > &vars, const bool &print_all, const unsigned &time_step);
+
+   bool _timeSeries;
+   unsigned _timeSeriesSpaceChunk;
+   unsigned _timeSeriesTimeChunk;
+   unsigned _gzipLevel;
+   bool _shuffle;
+   bool _szip;
+
+   /** the time steps already in the series, and its number of nodes and elements, for each order */
+   std::vector < unsigned > _timeSeriesSteps[3];
+   unsigned _timeSeriesNvt[3];
+   unsigned _timeSeriesNel[3];
+
    static const std::string type_el[3][N_GEOM_ELS];
    
    static const std::string _nodes_name;
@@ -0,0 +1,108 @@
+#include <sstream>
+#include <cmath>
+#include "FemusDefault.hpp"
+#include "FemusInit.hpp"
+#include "MultiLevelMesh.hpp"
+#include "MultiLevelSolution.hpp"
+#include "InSituAnalysis.hpp"
+
+using namespace femus;
+
+// Test for the in-situ analysis on the unit cube: the volume, the integral of x, the area of the boundary,
+// the flux of x through the boundary and a probe of x are compared with their exact values
+
+
+double InitialValueX(const std::vector < double >& x) {
+  return x[0];
+}
+
+double Volume(const std::vector < double > &x, const std::vector < double > &solution,
+              const std::vector < std::vector < double > > &gradient, const double &time) {
+  return 1.;
+}
+
+double VolumeX(const std::vector < double > &x, const std::vector < double > &solution,
+               const std::vector < std::vector < double > > &gradient, const double &time) {
+  return solution[0];
+}
+
+double Area(const std::vector < double > &x, const std::vector < double > &normal,
+            const std::vector < double > &solution, const double &time) {
+  return 1.;
+}
+
+double FluxX(const std::vector < double > &x, const std::vector < double > &normal,
+             const std::vector < double > &solution, const double &time) {
+  return solution[0] * normal[0];
+}
+
+int main(int argc,char **args) {
+
+  FemusInit init(argc,args,MPI_COMM_WORLD);
+
+  std::string neu_file = "cube_all_shapes.neu";
+  std::ostringstream mystream; mystream << "./" << DEFAULT_INPUTDIR << "/" << neu_file;
+  const std::string infile = mystream.str();
+
+  //Adimensional
+  double Lref = 1.;
+
+  MultiLevelMesh ml_msh;
+  ml_msh.ReadCoarseMesh(infile.c_str(),"seventh",Lref);
+  ml_msh.RefineMesh(2, 2, NULL);
+
+  MultiLevelSolution ml_sol(&ml_msh);
+  ml_sol.AddSolution("U", LAGRANGE, SECOND);
+  ml_sol.Initialize("U", InitialValueX);
+
+  std::vector < std::string > variables(1, "U");
+  InSituAnalysis analysis(&ml_sol);
+  analysis.AddVolumeIntegral("volume", variables, Volume);
+  analysis.AddVolumeIntegral("integralX", variables, VolumeX);
+  // the six sides of the cube
+  for (int faceIndex = 1; faceIndex <= 6; faceIndex++) {
+    std::ostringstream area; area << "area" << faceIndex;
+    analysis.AddBoundaryIntegral(area.str(), variables, Area, faceIndex);
+    std::ostringstream flux; flux << "flux" << faceIndex;
+    analysis.AddBoundaryIntegral(flux.str(), variables, FluxX, faceIndex);
+  }
+  std::vector < double > point(3, 0.5);
+  point[0] = 1.;
+  analysis.AddProbe("probe", "U", point);
+
+  analysis.Evaluate();
+
+  double area = 0., flux = 0.;
+  for (int faceIndex = 1; faceIndex <= 6; faceIndex++) {
+    std::ostringstream areaName; areaName << "area" << faceIndex;
+    area += analysis.GetValue(areaName.str());
+    std::ostringstream fluxName; fluxName << "flux" << faceIndex;
+    flux += analysis.GetValue(fluxName.str());
+  }
+
+  int error = 0;
+  if( fabs(analysis.GetValue("volume") - 1.) > 1.e-12 ) {
+    std::cout << "Wrong volume " << analysis.GetValue("volume") << std::endl;
+    error = 1;
+  }
+  if( fabs(analysis.GetValue("integralX") - 0.5) > 1.e-12 ) {
+    std::cout << "Wrong integral of x " << analysis.GetValue("integralX") << std::endl;
+    error = 1;
+  }
+  if( fabs(area - 6.) > 1.e-12 ) {
+    std::cout << "Wrong boundary area " << area << std::endl;
+    error = 1;
+  }
+  // divergence theorem: the flux of (x, 0, 0) is the volume
+  if( fabs(flux - 1.) > 1.e-12 ) {
+    std::cout << "Wrong flux of x " << flux << std::endl;
+    error = 1;
+  }
+  if( fabs(analysis.GetValue("probe") - 1.) > 1.e-12 ) {
+    std::cout << "Wrong probe " << analysis.GetValue("probe") << std::endl;
+    error = 1;
+  }
+
+  // all the processes have the reduced values
+  return error;
+}
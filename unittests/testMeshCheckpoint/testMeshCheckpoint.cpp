@@ -0,0 +1,87 @@
+#include <sstream>
+#include <cmath>
+#include "FemusDefault.hpp"
+#include "FemusInit.hpp"
+#include "MultiLevelMesh.hpp"
+#include "NumericVector.hpp"
+
+using namespace femus;
+
+// Test for the coarse mesh checkpoint: a mixed hex, wedge and tet mesh is written and read back,
+// the restarted mesh has to have the same elements, connectivity, faces and coordinates
+
+
+int main(int argc,char **args) {
+
+  FemusInit init(argc,args,MPI_COMM_WORLD);
+
+  std::string neu_file = "cube_all_shapes.neu";
+  std::ostringstream mystream; mystream << "./" << DEFAULT_INPUTDIR << "/" << neu_file;
+  const std::string infile = mystream.str();
+
+  std::ostringstream checkpointstream; checkpointstream << "./" << DEFAULT_OUTPUTDIR << "/cube_all_shapes.fbm";
+  const std::string checkpoint = checkpointstream.str();
+
+  //Adimensional
+  double Lref = 1.;
+
+  Mesh::SetCoarseMeshCheckpoint(checkpoint);
+  MultiLevelMesh ml_msh;
+  ml_msh.ReadCoarseMesh(infile.c_str(),"seventh",Lref);
+
+  Mesh::SetCoarseMeshCheckpoint("");
+  MultiLevelMesh ml_msh_restart;
+  ml_msh_restart.ReadCoarseMesh(checkpoint.c_str(),"seventh",Lref);
+
+  Mesh *msh = ml_msh.GetLevel(0);
+  Mesh *mshRestart = ml_msh_restart.GetLevel(0);
+
+  int error = 0;
+
+  if( msh->GetNumberOfElements() != mshRestart->GetNumberOfElements() ||
+      msh->GetNumberOfNodes() != mshRestart->GetNumberOfNodes() ) {
+    std::cout << "The restarted mesh has a different number of elements or nodes" << std::endl;
+    error = 1;
+  }
+  else {
+    for (unsigned iel = 0; iel < msh->GetNumberOfElements(); iel++) {
+      if( msh->GetElementType(iel) != mshRestart->GetElementType(iel) ||
+          msh->GetElementGroup(iel) != mshRestart->GetElementGroup(iel) ||
+          msh->GetElementMaterial(iel) != mshRestart->GetElementMaterial(iel) ) {
+        std::cout << "Element " << iel << " has a different type, group or material" << std::endl;
+        error = 1;
+        break;
+      }
+      for (unsigned i = 0; i < msh->GetElementDofNumber(iel, 2); i++) {
+        if( msh->el->GetElementVertexIndex(iel, i) != mshRestart->el->GetElementVertexIndex(iel, i) ) {
+          std::cout << "Element " << iel << " has a different vertex " << i << std::endl;
+          error = 1;
+        }
+      }
+      for (unsigned jface = 0; jface < msh->GetElementFaceNumber(iel); jface++) {
+        if( msh->el->GetFaceElementIndex(iel, jface) != mshRestart->el->GetFaceElementIndex(iel, jface) ) {
+          std::cout << "Element " << iel << " has a different face " << jface << std::endl;
+          error = 1;
+        }
+      }
+      if( error ) break;
+    }
+
+    for (unsigned k = 0; k < 3; k++) {
+      NumericVector *x = msh->_topology->_Sol[k];
+      NumericVector *xRestart = mshRestart->_topology->_Sol[k];
+      for (int i = x->first_local_index(); i < x->last_local_index(); i++) {
+        if( fabs( (*x)(i) - (*xRestart)(i) ) > 1.e-14 ) {
+          std::cout << "Node " << i << " has a different coordinate " << k << std::endl;
+          error = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  int globalError;
+  MPI_Allreduce(&error, &globalError, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+  return globalError;
+}
@@ -0,0 +1,96 @@
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include "FemusDefault.hpp"
+#include "FemusInit.hpp"
+#include "MultiLevelMesh.hpp"
+#include "MultiLevelSolution.hpp"
+#include "NumericVector.hpp"
+
+using namespace femus;
+
+// Test for the solution checkpoint: the solutions of every family are written and read back,
+// with the argument "save" or "load" the two steps run separately, also on a different number of processes
+
+
+double InitialValue(const std::vector < double >& x) {
+  return 1. + x[0] + 2. * x[1] * x[1] - sin(3. * x[2]);
+}
+
+int main(int argc,char **args) {
+
+  FemusInit init(argc,args,MPI_COMM_WORLD);
+
+  bool save = (argc < 2 || !strcmp(args[1], "save"));
+  bool load = (argc < 2 || !strcmp(args[1], "load"));
+
+  std::string neu_file = "cube_all_shapes.neu";
+  std::ostringstream mystream; mystream << "./" << DEFAULT_INPUTDIR << "/" << neu_file;
+  const std::string infile = mystream.str();
+
+  // the separate save and load runs use their own file, so that they can run together with the single run
+  std::ostringstream checkpointstream;
+  checkpointstream << "./" << DEFAULT_OUTPUTDIR << ( ( argc < 2 ) ? "/solution.chk" : "/solution.restart.chk" );
+  const std::string checkpoint = checkpointstream.str();
+
+  //Adimensional
+  double Lref = 1.;
+
+  MultiLevelMesh ml_msh;
+  ml_msh.ReadCoarseMesh(infile.c_str(),"seventh",Lref);
+  ml_msh.RefineMesh(2, 2, NULL);
+
+  MultiLevelSolution ml_sol(&ml_msh);
+  ml_sol.AddSolution("U", LAGRANGE, SECOND, 2);
+  ml_sol.AddSolution("V", LAGRANGE, FIRST);
+  ml_sol.AddSolution("W", LAGRANGE, SERENDIPITY);
+  ml_sol.AddSolution("P", DISCONTINOUS_POLYNOMIAL, ZERO);
+  ml_sol.AddSolution("Q", DISCONTINOUS_POLYNOMIAL, FIRST);
+
+  if( save ) {
+    ml_sol.Initialize("All", InitialValue);
+    ml_sol.SaveCheckpoint(checkpoint, 0.5, 5);
+  }
+
+  int error = 0;
+
+  if( load ) {
+    MultiLevelSolution ml_sol_restart(&ml_msh);
+    ml_sol_restart.AddSolution("U", LAGRANGE, SECOND, 2);
+    ml_sol_restart.AddSolution("V", LAGRANGE, FIRST);
+    ml_sol_restart.AddSolution("W", LAGRANGE, SERENDIPITY);
+    ml_sol_restart.AddSolution("P", DISCONTINOUS_POLYNOMIAL, ZERO);
+    ml_sol_restart.AddSolution("Q", DISCONTINOUS_POLYNOMIAL, FIRST);
+    ml_sol_restart.Initialize("All");
+
+    double time;
+    unsigned time_step;
+    ml_sol_restart.LoadCheckpoint(checkpoint, time, time_step);
+    if( time != 0.5 || time_step != 5 ) {
+      std::cout << "The restarted solution has a different time or time step" << std::endl;
+      error = 1;
+    }
+
+    ml_sol.Initialize("All", InitialValue);
+    for (unsigned ig = 0; ig < ml_msh.GetNumberOfLevels(); ig++) {
+      for (unsigned k = 0; k < 5; k++) {
+        for (unsigned old = 0; old < 1u + (k == 0); old++) {
+          NumericVector *sol = (old == 0) ? ml_sol.GetSolutionLevel(ig)->_Sol[k] : ml_sol.GetSolutionLevel(ig)->_SolOld[k];
+          NumericVector *solRestart = (old == 0) ? ml_sol_restart.GetSolutionLevel(ig)->_Sol[k] : ml_sol_restart.GetSolutionLevel(ig)->_SolOld[k];
+          for (int i = sol->first_local_index(); i < sol->last_local_index(); i++) {
+            if( fabs( (*sol)(i) - (*solRestart)(i) ) > 1.e-14 ) {
+              std::cout << "Level " << ig << ": dof " << i << " of " << ml_sol.GetSolutionName(k) << " has a different value" << std::endl;
+              error = 1;
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  int globalError;
+  MPI_Allreduce(&error, &globalError, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+  return globalError;
+}